@@ -0,0 +1,571 @@
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "bot.h"
+
+/*
+ * Core benchmark suite.
+ * Times the game's hot paths one operation at a time (micro) and whole bot
+ * games through command_handle (macro), and prints one line per benchmark:
+ *
+ *   <name> <iterations> <ns> ns/op <allocs> allocs/op <bytes> B/op
+ *
+ * allocs/op and B/op are averages, so an allocation made once every hundred
+ * operations shows up as 0.01.
+ *
+ * Allocations are counted by linking with -Wl,--wrap=malloc,--wrap=calloc,
+ * --wrap=realloc (see the Makefile), so they cover the game's own code, not
+ * what the C library allocates inside fopen and the like.
+ *
+ * Usage: Dungeons_of_AYBU_bench [--baseline <file>] [--timing-baseline <file>]
+ *        [--write-baseline <file>] [--filter <text>] [--time <ms>] [--count <n>]
+ *        [--threshold <percent>]
+ * A baseline is a file of lines in the format above. With --baseline every
+ * benchmark's allocations are compared to it: more allocs/op or B/op (at the
+ * printed precision) is a regression. Timings only mean something on the
+ * machine that measured them, so ns/op are only compared with
+ * --timing-baseline, a baseline written on this machine: more than threshold
+ * percent (default 20) slower is a regression. The exit status is 1 if there
+ * was any regression.
+ */
+
+// Every game and random stream of the suite is keyed by this seed
+#define BENCH_SEED 42
+#define BENCH_MAX_RESULTS 32
+// Bot commands per macro benchmark operation
+#define BENCH_BOT_STEPS 1000
+
+typedef struct BenchState {
+    Player *pl;
+    Rng rng;
+    Room rooms[2];
+    Item item;
+    Enemy enemy;
+    Bot bot;
+    unsigned char save[2 * SAVE_MAX_SIZE]; // the benchmark games know a few rooms at most
+    char dir[64];  // temporary directory the save files go to
+    char cwd[512]; // where to come back to
+    uint64_t i;    // operations so far
+} BenchState;
+
+typedef struct Benchmark {
+    const char *name;
+    void (*setup)(BenchState *s);
+    void (*op)(BenchState *s);
+    void (*teardown)(BenchState *s);
+} Benchmark;
+
+typedef struct BenchResult {
+    char name[64];
+    uint64_t iterations;
+    double ns;
+    double allocs; // per op
+    double bytes;  // per op
+} BenchResult;
+
+/*
+###################################
+###     ALLOCATION COUNTING     ###
+###################################
+*/
+static uint64_t bench_allocs = 0;
+static uint64_t bench_alloc_bytes = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+// saves are written on the writer thread, so the counters are atomic
+static void bench_count(size_t bytes)
+{
+    __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_alloc_bytes, bytes, __ATOMIC_RELAXED);
+}
+void *__wrap_malloc(size_t size)
+{
+    bench_count(size);
+    return __real_malloc(size);
+}
+void *__wrap_calloc(size_t count, size_t size)
+{
+    bench_count(count * size);
+    return __real_calloc(count, size);
+}
+void *__wrap_realloc(void *p, size_t size)
+{
+    bench_count(size);
+    return __real_realloc(p, size);
+}
+
+/*
+###################################
+###         BENCHMARKS          ###
+###################################
+*/
+static void bench_setup_game(BenchState *s)
+{
+    screen_set_backend(&render_backend_null);
+    init_game_seeded(s->pl, BENCH_SEED);
+    rng_seed(&s->rng, BENCH_SEED, 0);
+}
+static void bench_room_create(BenchState *s)
+{
+    room_create_random(&s->rooms[0], (unsigned char)(1 << (s->i & 3)), &s->rng);
+}
+static void bench_item_create(BenchState *s)
+{
+    item_create_random(&s->item, &s->rng);
+}
+static void bench_enemy_create(BenchState *s)
+{
+    enemy_create_random(&s->enemy, &s->rng);
+}
+static void bench_setup_inventory(BenchState *s)
+{
+    bench_setup_game(s);
+    for (int i = 0; i < PLAYER_INV_SIZE; i++)
+    {
+        item_create_random(&s->pl->inventory[i], &s->rng);
+    }
+}
+static void bench_calculate_stats(BenchState *s)
+{
+    player_calculate_stats(s->pl);
+}
+static void bench_save_memory(BenchState *s)
+{
+    WorldImage world;
+    world_export(s->pl->world, &world);
+    size_t size = save_encode(s->pl, &world, s->save, sizeof(s->save));
+    world_image_free(&world);
+    save_restore(s->pl, s->save, size);
+}
+/* @
+ * bench_setup_save_files: void
+ * -----------------------------
+ * Moves into a temporary directory, so the save files and the save index of
+ * the round trips don't touch the player's own.
+ */
+static void bench_setup_save_files(BenchState *s)
+{
+    bench_setup_inventory(s);
+    snprintf(s->dir, sizeof(s->dir), "/tmp/aybu_bench_XXXXXX");
+    if (getcwd(s->cwd, sizeof(s->cwd)) == NULL || mkdtemp(s->dir) == NULL || chdir(s->dir) != 0)
+    {
+        fprintf(stderr, "Can not set up a directory for the save benchmark: %s\n", strerror(errno));
+        exit(-1);
+    }
+}
+/* @
+ * bench_save_files: void
+ * -----------------------
+ * A save the way the game does it (queued to the writer thread), waited for,
+ * then loaded back.
+ */
+static void bench_save_files(BenchState *s)
+{
+    save_player(s->pl, "bench");
+    save_shutdown();
+    save_take_done();
+    load_player(s->pl, "bench");
+}
+static void bench_teardown_save_files(BenchState *s)
+{
+    remove("save_bench.dat");
+    remove("saves.idx");
+    if (chdir(s->cwd) != 0 || rmdir(s->dir) != 0)
+    {
+        fprintf(stderr, "Can not clean up '%s': %s\n", s->dir, strerror(errno));
+    }
+}
+static void bench_setup_commands(BenchState *s)
+{
+    bench_setup_game(s);
+    char look[] = "look";
+    command_handle(look, s->pl);
+}
+/* @
+ * bench_command_handle: void
+ * ---------------------------
+ * Parses and dispatches commands that leave the game as it is, with nothing
+ * drawn: this is the cost of command_handle itself.
+ */
+static void bench_command_handle(BenchState *s)
+{
+    static const char *commands[] = { "look", "inventory", "help", "move", "attack nobody", "dance wildly" };
+    char input[128];
+    snprintf(input, sizeof(input), "%s", commands[s->i % (sizeof(commands) / sizeof(commands[0]))]);
+    command_handle(input, s->pl);
+}
+static void bench_setup_draw(BenchState *s)
+{
+    screen_set_backend(&render_backend_recording);
+    render_recording_set_size(80, 24);
+    init_game_seeded(s->pl, BENCH_SEED);
+    rng_seed(&s->rng, BENCH_SEED, 0);
+    // two different looked-at rooms, so every frame changes
+    for (int i = 0; i < 2; i++)
+    {
+        room_create_random(&s->rooms[i], (unsigned char)(1 << (i * 2)), &s->rng);
+        s->rooms[i].searched = true;
+    }
+    screen_flush();
+    render_recording_reset();
+}
+static void bench_draw_dungeon(BenchState *s)
+{
+    draw_dungeon(&s->rooms[s->i & 1]);
+    screen_flush();
+    render_recording_reset();
+}
+// draw_game clears the screen first, so the whole frame is sent every time
+static void bench_draw_full_frame(BenchState *s)
+{
+    draw_game(s->pl);
+    screen_flush();
+    render_recording_reset();
+}
+static void bench_teardown_draw(BenchState *s)
+{
+    (void)s;
+    screen_set_backend(&render_backend_null);
+    get_terminal_size();
+}
+/* @
+ * bench_bot_game: void
+ * ---------------------
+ * A bot plays BENCH_BOT_STEPS commands of the same game from its start; a bot
+ * that dies starts the game over.
+ */
+static void bench_bot_game(BenchState *s, BotPolicy policy)
+{
+    s->bot.policy = policy;
+    rng_seed(&s->bot.rng, BENCH_SEED, policy);
+    bot_new_game(&s->bot);
+    init_game_seeded(s->pl, BENCH_SEED);
+    char command[BOT_COMMAND_LENGTH];
+    for (int i = 0; i < BENCH_BOT_STEPS; i++)
+    {
+        bot_next_command(&s->bot, s->pl, command, sizeof(command));
+        command_handle(command, s->pl);
+        if (!player_check_alive(s->pl))
+        {
+            bot_new_game(&s->bot);
+            init_game_seeded(s->pl, BENCH_SEED);
+        }
+    }
+}
+static void bench_bot_explorer(BenchState *s)
+{
+    bench_bot_game(s, BOT_EXPLORER);
+}
+static void bench_bot_fighter(BenchState *s)
+{
+    bench_bot_game(s, BOT_FIGHTER);
+}
+
+static const Benchmark bench_suite[] = {
+    { "room_create_random", bench_setup_game, bench_room_create, NULL },
+    { "item_create_random", bench_setup_game, bench_item_create, NULL },
+    { "enemy_create_random", bench_setup_game, bench_enemy_create, NULL },
+    { "player_calculate_stats", bench_setup_inventory, bench_calculate_stats, NULL },
+    { "save_encode_restore", bench_setup_inventory, bench_save_memory, NULL },
+    { "save_load_file", bench_setup_save_files, bench_save_files, bench_teardown_save_files },
+    { "command_handle", bench_setup_commands, bench_command_handle, NULL },
+    { "draw_dungeon", bench_setup_draw, bench_draw_dungeon, bench_teardown_draw },
+    { "draw_full_frame", bench_setup_draw, bench_draw_full_frame, bench_teardown_draw },
+    { "game_explorer_1000", bench_setup_game, bench_bot_explorer, NULL },
+    { "game_fighter_1000", bench_setup_game, bench_bot_fighter, NULL },
+};
+
+/*
+###################################
+###           RUNNER            ###
+###################################
+*/
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+/* @
+ * bench_measure: double
+ * ----------------------
+ * Runs n operations.
+ *
+ * Returns:
+ * - Elapsed nanoseconds.
+ */
+static double bench_measure(const Benchmark *b, BenchState *s, uint64_t n)
+{
+    double start = now_ns();
+    for (uint64_t i = 0; i < n; i++)
+    {
+        b->op(s);
+        s->i++;
+    }
+    return now_ns() - start;
+}
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+/* @
+ * bench_run: void
+ * ----------------
+ * Finds how many operations take about target_ns (growing the count from 1,
+ * which also warms the caches up), then times count runs of that many and
+ * keeps the fastest: other load on the machine only ever adds time.
+ * Allocations are averaged over the timed runs.
+ */
+static void bench_run(const Benchmark *b, BenchState *s, double target_ns, int count, BenchResult *r)
+{
+    s->i = 0;
+    b->setup(s);
+    uint64_t n = 1;
+    while (1)
+    {
+        double elapsed = bench_measure(b, s, n);
+        if (elapsed >= target_ns || n >= 1000000000ull)
+        {
+            break;
+        }
+        double grow = elapsed > 0 ? 1.2 * target_ns / elapsed : 100;
+        uint64_t next = (uint64_t)(n * (grow < 100 ? grow : 100));
+        n = next > n ? next : n + 1;
+    }
+    double ns[count];
+    uint64_t allocs = __atomic_load_n(&bench_allocs, __ATOMIC_RELAXED);
+    uint64_t bytes = __atomic_load_n(&bench_alloc_bytes, __ATOMIC_RELAXED);
+    for (int i = 0; i < count; i++)
+    {
+        ns[i] = bench_measure(b, s, n) / n;
+    }
+    allocs = __atomic_load_n(&bench_allocs, __ATOMIC_RELAXED) - allocs;
+    bytes = __atomic_load_n(&bench_alloc_bytes, __ATOMIC_RELAXED) - bytes;
+    if (b->teardown != NULL)
+    {
+        b->teardown(s);
+    }
+    qsort(ns, count, sizeof(double), compare_double);
+    snprintf(r->name, sizeof(r->name), "%s", b->name);
+    r->iterations = n;
+    r->ns = ns[0];
+    r->allocs = (double)allocs / (n * count);
+    r->bytes = (double)bytes / (n * count);
+}
+/* @
+ * bench_load_baseline: int
+ * -------------------------
+ * Reads a baseline file, '#' lines are comments.
+ *
+ * Returns:
+ * - The number of results read, -1 if the file can not be opened.
+ */
+static int bench_load_baseline(const char *path, BenchResult *results, int max)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    char line[256];
+    int count = 0;
+    while (count < max && fgets(line, sizeof(line), file) != NULL)
+    {
+        BenchResult *r = &results[count];
+        unsigned long long iterations;
+        if (line[0] != '#' && sscanf(line, "%63s %llu %lf ns/op %lf allocs/op %lf B/op", r->name, &iterations, &r->ns, &r->allocs, &r->bytes) == 5)
+        {
+            r->iterations = iterations;
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+static void bench_print(FILE *out, const BenchResult *r)
+{
+    fprintf(out, "%-24s %10llu %12.1f ns/op %8.2f allocs/op %10.1f B/op", r->name, (unsigned long long)r->iterations, r->ns,
+            r->allocs, r->bytes);
+}
+/* @
+ * bench_more: bool
+ * -----------------
+ * Whether a per op average is above the baseline's once both are rounded to
+ * unit, the precision they are printed with, so rounding noise in amortized
+ * allocations doesn't count.
+ */
+static bool bench_more(double value, double base, double unit)
+{
+    return (long long)(value / unit + 0.5) > (long long)(base / unit + 0.5);
+}
+/* @
+ * bench_find: const BenchResult*
+ * -------------------------------
+ * The baseline result of a benchmark, or NULL if the baseline doesn't have it.
+ */
+static const BenchResult *bench_find(const BenchResult *results, int count, const char *name)
+{
+    for (int k = 0; k < count; k++)
+    {
+        if (strcmp(results[k].name, name) == 0)
+        {
+            return &results[k];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_path = NULL;
+    const char *timing_path = NULL;
+    const char *write_path = NULL;
+    const char *filter = NULL;
+    double target_ms = 100;
+    int count = 5;
+    double threshold = 20;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baseline_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--timing-baseline") == 0 && i + 1 < argc)
+        {
+            timing_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc)
+        {
+            write_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc)
+        {
+            target_ms = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = strtod(argv[++i], NULL);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--baseline <file>] [--timing-baseline <file>] [--write-baseline <file>] [--filter <text>] [--time <ms>] [--count <n>] [--threshold <percent>]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (count < 1)
+    {
+        count = 1;
+    }
+    if (target_ms <= 0)
+    {
+        target_ms = 1;
+    }
+    // paths are opened relative to where the suite started, see bench_setup_save_files
+    BenchResult baseline[BENCH_MAX_RESULTS], timing[BENCH_MAX_RESULTS];
+    int baseline_count = 0, timing_count = 0;
+    if (baseline_path != NULL)
+    {
+        baseline_count = bench_load_baseline(baseline_path, baseline, BENCH_MAX_RESULTS);
+        if (baseline_count < 0)
+        {
+            fprintf(stderr, "Can not open baseline '%s': %s\n", baseline_path, strerror(errno));
+            return -1;
+        }
+    }
+    if (timing_path != NULL)
+    {
+        timing_count = bench_load_baseline(timing_path, timing, BENCH_MAX_RESULTS);
+        if (timing_count < 0)
+        {
+            fprintf(stderr, "Can not open baseline '%s': %s\n", timing_path, strerror(errno));
+            return -1;
+        }
+    }
+    FILE *write_file = NULL;
+    if (write_path != NULL)
+    {
+        write_file = fopen(write_path, "w");
+        if (write_file == NULL)
+        {
+            fprintf(stderr, "Can not write baseline '%s': %s\n", write_path, strerror(errno));
+            return -1;
+        }
+        fprintf(write_file, "# Dungeons_of_AYBU_bench baseline, ns/op are only comparable on the machine that wrote it (--timing-baseline)\n");
+    }
+
+    names_init();
+    BenchState *s = (BenchState *)calloc(1, sizeof(BenchState));
+    s->pl = (Player *)calloc(1, sizeof(Player));
+    int regressions = 0;
+    for (size_t i = 0; i < sizeof(bench_suite) / sizeof(bench_suite[0]); i++)
+    {
+        const Benchmark *b = &bench_suite[i];
+        if (filter != NULL && strstr(b->name, filter) == NULL)
+        {
+            continue;
+        }
+        BenchResult r;
+        bench_run(b, s, target_ms * 1e6, count, &r);
+        bench_print(stdout, &r);
+        if (write_file != NULL)
+        {
+            bench_print(write_file, &r);
+            fprintf(write_file, "\n");
+        }
+        const BenchResult *base = bench_find(baseline, baseline_count, r.name);
+        const BenchResult *timed = bench_find(timing, timing_count, r.name);
+        bool regressed = false;
+        if (timed != NULL)
+        {
+            double change = timed->ns > 0 ? 100.0 * (r.ns - timed->ns) / timed->ns : 0;
+            printf("  %+7.1f%%", change);
+            regressed = change > threshold;
+        }
+        if (base != NULL)
+        {
+            regressed |= bench_more(r.allocs, base->allocs, 0.01) || bench_more(r.bytes, base->bytes, 0.1);
+        }
+        if (regressed)
+        {
+            printf("  REGRESSION");
+        }
+        else if ((baseline_path != NULL && base == NULL) || (timing_path != NULL && timed == NULL))
+        {
+            printf("  (new)");
+        }
+        regressions += regressed;
+        printf("\n");
+        fflush(stdout);
+    }
+    if (write_file != NULL)
+    {
+        fclose(write_file);
+    }
+    if (baseline_path != NULL || timing_path != NULL)
+    {
+        printf("%d regression%s", regressions, regressions == 1 ? "" : "s");
+        if (baseline_path != NULL)
+        {
+            printf(", allocations against %s", baseline_path);
+        }
+        if (timing_path != NULL)
+        {
+            printf(", timings against %s (threshold %.0f%%)", timing_path, threshold);
+        }
+        printf("\n");
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+#include <time.h>
+
+#include "main.h"
+
+/*
+ * Render cost benchmark.
+ * Plays a fixed script of commands through command_handle with the recording
+ * backend and reports, per command type and terminal size, how many bytes and
+ * write calls reached the "terminal" and how long the full command cycle took.
+ */
+
+#define BENCH_ROUNDS 200
+#define BENCH_MAX_SAMPLES 8192
+// Every terminal size plays the same game, so runs can be compared
+#define BENCH_SEED 42
+
+typedef struct Sizes {
+    int width;
+    int height;
+} Sizes;
+
+typedef struct CommandStats {
+    const char *name;
+    int count;
+    size_t bytes;
+    int writes;
+    double latency_us[BENCH_MAX_SAMPLES];
+} CommandStats;
+
+static const Sizes bench_sizes[] = { { 80, 24 }, { 120, 40 }, { 200, 60 } };
+
+static CommandStats bench_stats[] = {
+    { "move", 0, 0, 0, { 0 } },
+    { "look", 0, 0, 0, { 0 } },
+    { "attack", 0, 0, 0, { 0 } },
+    { "hit", 0, 0, 0, { 0 } },
+    { "inventory", 0, 0, 0, { 0 } },
+    { "help", 0, 0, 0, { 0 } },
+};
+
+static double now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+/* @
+ * bench_command: void
+ * --------------------
+ * Runs one command the way the main loop does (clear input, handle, flush)
+ * and books its bytes, writes and latency under the command's first word.
+ */
+static void bench_command(Player *pl, const char *command)
+{
+    CommandStats *stats = NULL;
+    for (size_t i = 0; i < sizeof(bench_stats) / sizeof(bench_stats[0]); i++)
+    {
+        if (strncmp(command, bench_stats[i].name, strlen(bench_stats[i].name)) == 0)
+        {
+            stats = &bench_stats[i];
+        }
+    }
+    char input[128];
+    snprintf(input, sizeof(input), "%s", command);
+
+    size_t bytes = render_recording_bytes();
+    int writes = render_recording_writes();
+    double start = now_us();
+
+    clear_input();
+    move_cursor_default();
+    command_handle(input, pl);
+    move_cursor_default();
+    screen_flush();
+
+    double elapsed = now_us() - start;
+    if (stats != NULL && stats->count < BENCH_MAX_SAMPLES)
+    {
+        stats->latency_us[stats->count++] = elapsed;
+        stats->bytes += render_recording_bytes() - bytes;
+        stats->writes += render_recording_writes() - writes;
+    }
+    // only the counters matter, don't let the recording grow forever
+    if (render_recording_bytes() > (1 << 20))
+    {
+        render_recording_reset();
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, int count, double p)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+/* @
+ * bench_round: void
+ * ------------------
+ * One scripted round: look, fight whatever is there, check inventory and help,
+ * then leave through the first open door.
+ */
+static void bench_round(Player *pl)
+{
+    bench_command(pl, "look");
+    if (player_init_attack(pl, "") != -1)
+    {
+        bench_command(pl, "attack");
+        for (int i = 0; i < 50 && pl->onWar && pl->health > 0; i++)
+        {
+            bench_command(pl, "hit");
+        }
+    }
+    bench_command(pl, "inventory");
+    bench_command(pl, "help");
+    const char *directions[] = { "move left", "move down", "move right", "move up" };
+    for (int i = 0; i < 4; i++)
+    {
+        if (pl->room->doors & (0b0001 << i))
+        {
+            bench_command(pl, directions[i]);
+            break;
+        }
+    }
+}
+
+int main()
+{
+    Player *pl = (Player *)calloc(1, sizeof(Player));
+    screen_set_backend(&render_backend_recording);
+
+    printf("%-9s %-9s %7s %10s %9s %9s %9s %9s\n", "size", "command", "count", "bytes/cmd", "writes", "p50(us)", "p90(us)", "p99(us)");
+    for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++)
+    {
+        render_recording_set_size(bench_sizes[s].width, bench_sizes[s].height);
+        render_recording_reset();
+        for (size_t i = 0; i < sizeof(bench_stats) / sizeof(bench_stats[0]); i++)
+        {
+            bench_stats[i].count = 0;
+            bench_stats[i].bytes = 0;
+            bench_stats[i].writes = 0;
+        }
+        init_game_seeded(pl, BENCH_SEED);
+        screen_flush();
+        for (int round = 0; round < BENCH_ROUNDS; round++)
+        {
+            bench_round(pl);
+        }
+
+        char size[16];
+        snprintf(size, sizeof(size), "%dx%d", bench_sizes[s].width, bench_sizes[s].height + 1);
+        for (size_t i = 0; i < sizeof(bench_stats) / sizeof(bench_stats[0]); i++)
+        {
+            CommandStats *stats = &bench_stats[i];
+            qsort(stats->latency_us, stats->count, sizeof(double), compare_double);
+            int count = stats->count ? stats->count : 1;
+            printf("%-9s %-9s %7d %10.1f %9.2f %9.1f %9.1f %9.1f\n", size, stats->name, stats->count,
+                   (double)stats->bytes / count, (double)stats->writes / count,
+                   percentile(stats->latency_us, stats->count, 0.50),
+                   percentile(stats->latency_us, stats->count, 0.90),
+                   percentile(stats->latency_us, stats->count, 0.99));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "player.h"
+
+// Longest command a bot types, "pickup " and an item name
+#define BOT_COMMAND_LENGTH 64
+
+// How a bot plays
+typedef enum {
+    BOT_EXPLORER, // walks to the rooms it saw least recently, fights what blocks the way, flees when hurt
+    BOT_FIGHTER,  // attacks every enemy it sees and never flees
+    BOT_COWARD,   // never fights for real: flees every fight, even the ones it starts
+    BOT_POLICY_COUNT
+} BotPolicy;
+
+// A room the bot has been in this game
+typedef struct BotVisit {
+    int32_t x, y;
+    uint32_t last; // the bot's move count when it was last here + 1, 0: empty slot
+} BotVisit;
+
+// Automatic player: looks at the game state the way the screen shows it and
+// answers with the command a human would type next
+typedef struct Bot {
+    BotPolicy policy;
+    Rng rng;           // the bot's own choices, apart from the game's rolls
+    BotVisit *visits;  // open addressing by (x, y), at most half full
+    uint32_t capacity;
+    uint32_t explored; // rooms entered this game
+    uint32_t moves;    // rooms walked this game
+} Bot;
+
+void bot_init(Bot *b, BotPolicy policy, uint64_t seed, uint64_t stream);
+void bot_new_game(Bot *b);
+void bot_free(Bot *b);
+void bot_next_command(Bot *b, Player *pl, char *command, size_t size);
+
+const char *bot_policy_name(BotPolicy policy);
+bool bot_policy_find(const char *name, BotPolicy *policy);
+
+#endif
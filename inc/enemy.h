@@ -6,6 +6,8 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "rng.h"
+
 // Enemy structure
 typedef struct Enemy {
     float health;
@@ -26,7 +28,7 @@ typedef enum {
 } EnemyType;
 
 
-void enemy_create_random(Enemy *e);
+void enemy_create_random(Enemy *e, Rng *rng);
 void enemy_create_none(Enemy *e);
 void enemy_get_hit(Enemy *e, float damage);
 
@@ -35,6 +37,6 @@ char *enemy_get_simple_name(EnemyType type);
 
 bool enemy_is_alive(Enemy *e);
 
-float enemy_attack(Enemy *e);
+float enemy_attack(Enemy *e, Rng *rng);
 
 #endif
\ No newline at end of file
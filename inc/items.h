@@ -1,11 +1,15 @@
 #ifndef ITEMS_H
 #define ITEMS_H
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
 #include <stdbool.h>
 
+#include "rng.h"
+#include "names.h"
+
 // Item structure
 typedef struct Item {
     float health;
@@ -14,7 +18,7 @@ typedef struct Item {
     float crit_rate;
     float crit_chance;
     int type;
-    char *name;
+    NameId name; // index into the interned name table, see names_get
     bool looted;
 } Item;
 
@@ -27,7 +31,6 @@ typedef enum {
     ITEM_GENERAL
 } ItemType;
 
-void item_create_random(Item *i);
-char *item_get_random_name(char* list[], char* last);
+void item_create_random(Item *i, Rng *rng);
 
 #endif
\ No newline at end of file
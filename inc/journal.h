@@ -0,0 +1,30 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "player.h"
+
+// Commands between two snapshots of the session
+#define JOURNAL_SNAPSHOT_EVERY 64
+// Commands buffered in memory before they are handed to the OS (never fsynced)
+#define JOURNAL_BATCH 8
+#define JOURNAL_BUFFER_SIZE 4096
+
+int journal_open(const char *session, Player *pl);
+void journal_record(const char *input, Player *pl);
+void journal_commit(Player *pl);
+void journal_flush();
+void journal_report();
+void journal_close(bool clean);
+
+void journal_watch_hangup();
+bool journal_take_hangup();
+
+#endif
@@ -9,7 +9,12 @@
 #include "room.h"
 #include "enemy.h"
 #include "items.h"
+#include "journal.h"
 
+void game_set_seed(uint64_t seed);
+void game_set_procedural(bool procedural);
 void init_game(Player *pl);
+void init_game_seeded(Player *pl, uint64_t seed);
+int game_run_script(Player *pl, FILE *script);
 
 #endif
@@ -0,0 +1,34 @@
+#ifndef NAMES_H
+#define NAMES_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "rng.h"
+
+// Id of an interned room or item name. 0 is the empty name.
+typedef unsigned char NameId;
+
+#define NAME_NONE 0
+#define NAMES_MAX 64
+#define NAME_LENGTH 24
+
+// Groups of names the generators pick from
+typedef enum {
+    NAMES_ROOM,
+    NAMES_SWORD,
+    NAMES_SHIELD,
+    NAMES_ELIXIR,
+    NAMES_GENERAL,
+    NAMES_GROUP_COUNT
+} NameGroup;
+
+void names_init();
+
+const char *names_get(NameId id);
+NameId names_find(const char *name);
+NameId names_in_group(NameGroup group, int index);
+NameId names_random(NameGroup group, Rng *rng);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "world.h"
+
+// Distance fields kept at once, the least recently used target is replaced
+#define PATH_FIELDS 4
+// Rooms a single field may cover; a procedural world is searched up to this far
+#define PATH_MAX_ROOMS 65536
+
+// Distance of one known room to the field's target
+typedef struct PathNode {
+    int32_t x, y;
+    uint32_t dist; // steps to the target + 1, 0: empty slot
+} PathNode;
+
+typedef struct PathPoint {
+    int32_t x, y;
+} PathPoint;
+
+// Breadth-first search outwards from a target over the known door graph.
+// It is stopped as soon as the asked room is reached and resumed from its
+// queue the next time, until the map changes (World.version).
+typedef struct PathField {
+    int32_t tx, ty;
+    uint32_t version;   // World.version the field was built for
+    uint32_t last_use;
+    bool used;
+    PathNode *nodes;    // open addressing by (x, y), at most half full
+    uint32_t capacity;
+    uint32_t count;
+    PathPoint *queue;   // rooms whose neighbors are not searched yet
+    uint32_t head, tail, queue_capacity;
+} PathField;
+
+typedef struct PathCache {
+    PathField fields[PATH_FIELDS];
+    uint32_t uses;
+    uint64_t hits;   // lookups answered by a field without searching further
+    uint64_t builds; // fields (re)started from their target
+} PathCache;
+
+PathCache *path_cache_create();
+uint32_t path_distance(PathCache *cache, World *w, int32_t x, int32_t y, int32_t tx, int32_t ty);
+int path_next(PathCache *cache, World *w, int32_t x, int32_t y, int32_t tx, int32_t ty);
+
+#endif
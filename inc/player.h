@@ -7,9 +7,27 @@
 
 #include "items.h"
 #include "room.h"
+#include "world.h"
+#include "path.h"
 
 #define PLAYER_INV_SIZE 6
 
+// What the player does in a round of a fight
+typedef enum {
+    WAR_HIT,
+    WAR_KICK,
+    WAR_FLEE
+} WarAction;
+
+// How a round of a fight ended
+typedef enum {
+    WAR_EXCHANGED,    // both hit and both are still alive
+    WAR_ENEMY_KILLED,
+    WAR_PLAYER_DIED,
+    WAR_FLED,
+    WAR_FLEE_FAILED   // the enemy hit the fleeing player (who may have died)
+} WarOutcome;
+
 // Player structure
 typedef struct Player {
     float health;
@@ -23,6 +41,13 @@ typedef struct Player {
     bool onWar;
     int warIndex;
     Item inventory[PLAYER_INV_SIZE];
+    Rng rng; // session random state, rooms and fights fork their own from it
+    Rng war_rng; // rolls of the current fight
+    int32_t x, y; // position in the world, the first room is (0, 0)
+    uint32_t room_index; // generation index of the current room
+    World *world; // session map of visited rooms
+    PathCache *paths; // session distance fields for goto
+    RoomPool *rooms; // session room slots, room points into it
     Room *room;
 } Player;
 
@@ -37,11 +62,13 @@ bool player_check_has_same(Player *pl);
 bool player_check_inv_has(Player *pl, char *arg);
 bool player_drop_item(Player *pl, char *arg);
 bool player_move(Player *pl, int direction);
+int player_goto(Player *pl, int32_t x, int32_t y);
 
 int player_get_item(Player *pl);
 int player_get_inv_size(Player *pl);
 int player_init_attack(Player *pl, char *arg);
 float player_attack(Player *pl, int multiplier);
+WarOutcome player_war_round(Player *pl, WarAction action, float *dealt, float *taken);
 
 
 // to fix typedef imports from screen.h;
@@ -0,0 +1,37 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+
+// Render backend, the place screen.c sends finished frames to.
+typedef struct RenderBackend {
+    const char *name;
+    bool draws; // false: drawing calls return early, no frame is composed at all
+    void (*get_size)(int *width, int *height);
+    void (*write)(const char *data, size_t len);
+} RenderBackend;
+
+extern const RenderBackend render_backend_ansi;
+extern const RenderBackend render_backend_null;
+extern const RenderBackend render_backend_recording;
+
+const RenderBackend *render_backend_find(const char *name);
+
+void render_recording_set_size(int width, int height);
+void render_recording_reset();
+const char *render_recording_data(size_t *len);
+size_t render_recording_bytes();
+int render_recording_writes();
+
+#endif
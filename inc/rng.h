@@ -0,0 +1,38 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+// What a forked generator is used for, so equal indexes in different
+// domains still get unrelated numbers.
+typedef enum {
+    RNG_DOMAIN_ROOM = 1,
+    RNG_DOMAIN_FIGHT,
+    RNG_DOMAIN_WORLD
+} RngDomain;
+
+// Random number generator state. Every session carries its own, so rolls
+// don't depend on global rand() state or on the current second.
+// - Stream mode (PCG32): one sequence, state advances with every roll.
+// - Counter mode (Philox4x32-10): roll n of stream s under key k is a pure
+//   function of (k, s, n), so any room or fight can be regenerated on its own.
+typedef struct Rng {
+    uint64_t state;
+    uint64_t inc;
+    bool counter_mode;
+    uint64_t key;     // run seed
+    uint64_t stream;  // domain and index, see rng_fork
+    uint64_t counter; // roll index within the stream
+} Rng;
+
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+void rng_seed_from_time(Rng *rng, uint64_t stream);
+void rng_seed_counter(Rng *rng, uint64_t seed);
+void rng_fork(Rng *parent, Rng *child, RngDomain domain, uint64_t index);
+
+uint32_t rng_next(Rng *rng);
+int rng_range(Rng *rng, int n);
+
+#endif
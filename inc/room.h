@@ -7,21 +7,36 @@
 #include "enemy.h"
 #include "items.h"
 
+// Rooms alive at once: the current one and the one being entered
+#define ROOM_POOL_SIZE 2
+// Enough for four space separated enemy names ("SKELETON " is the longest)
+#define ROOM_ENEMY_NAMES_LENGTH 48
+
 typedef struct Room {
     short doors; // Open doors for navigating
     bool searched; // Whether "look" command executed
-    char *name;
+    NameId name; // index into the interned name table, see names_get
     Enemy mobs[4];
     Item item;
 } Room;
 
-void room_create_random(Room *r, unsigned char open_doors);
+// Fixed set of Room slots owned by a session. Rooms are recycled on every
+// room transition instead of being allocated, so memory stays flat however far the player walks.
+typedef struct RoomPool {
+    Room rooms[ROOM_POOL_SIZE];
+    bool used[ROOM_POOL_SIZE];
+} RoomPool;
+
+void room_pool_reset(RoomPool *pool);
+Room *room_pool_acquire(RoomPool *pool);
+void room_pool_release(RoomPool *pool, Room *r);
+
+void room_create_random(Room *r, unsigned char open_doors, Rng *rng);
 bool room_look(Room *r);
 
-char* room_get_enemy_names(Room *r);
-char* room_get_open_doors(Room *r);
-char* room_get_item_name(Room *r);
-char *room_get_random_name(char* list[], char* last);
+size_t room_get_enemy_names(Room *r, char *buffer, size_t size);
+const char* room_get_open_doors(Room *r);
+const char* room_get_item_name(Room *r);
 unsigned char room_get_door_bit(int direction);
 
 #endif
\ No newline at end of file
@@ -5,11 +5,26 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ctype.h>
 
 #include "player.h"
 
+// Largest encoded save without the rooms of its map
+#define SAVE_MAX_SIZE 1024
+
 void save_player(Player *player, char *filename);
-void load_player(Player *player, char *filename);
-void list_saves();
+bool save_take_done();
+void save_shutdown();
+bool load_player(Player *player, char *filename);
+void list_saves(char *arg);
+
+uint32_t save_crc32(const unsigned char *data, size_t size);
+size_t save_encode(Player *player, WorldImage *world, unsigned char *data, size_t size);
+size_t save_encode_file(Player *player, WorldImage *world, FILE *file);
+bool save_restore(Player *player, unsigned char *data, size_t size);
+unsigned char *save_read_file(const char *path, size_t *size);
 
 #endif
\ No newline at end of file
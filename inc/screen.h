@@ -4,15 +4,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
 
-#ifdef _WIN32
-    #include <windows.h>
-#else
-    #include <sys/ioctl.h>
-    #include <unistd.h>
-    #include <stdarg.h>
-#endif
-
+#include "render.h"
 #include "room.h"
 #include "player.h"
 #include "items.h"
@@ -33,7 +30,15 @@
 #define CMD_STRING_OFFSET_S 2
 
 // Function headers
+void screen_set_backend(const RenderBackend *b);
+const RenderBackend *screen_get_backend();
 void get_terminal_size();
+int get_info_width();
+void screen_watch_resize();
+bool screen_take_resize();
+
+void screen_print(const char *format, ...);
+void screen_flush();
 
 void draw_borders();
 void draw_text(const char *text, int x, int y);
@@ -41,6 +46,7 @@ void draw_text_center(const char *text, int y, ...);
 void draw_input_text();
 void draw_output_text(const char *format, ...);
 
+void draw_game(Player *pl);
 void draw_dungeon(Room *r);
 void draw_player();
 void draw_mobs(Enemy *mobs);
@@ -0,0 +1,135 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "room.h"
+#include "rng.h"
+
+// Rooms are kept in WORLD_CHUNK x WORLD_CHUNK squares (a power of two).
+// WORLD_CACHE_BYTES of chunks stay in memory, the least recently used ones
+// beyond that are spilled to the session's chunk file and read back on demand.
+#define WORLD_CHUNK 16
+#define WORLD_CHUNK_ROOMS (WORLD_CHUNK * WORLD_CHUNK)
+#ifndef WORLD_CACHE_BYTES
+#define WORLD_CACHE_BYTES (320 * 1024)
+#endif
+#define WORLD_CACHE_CHUNKS (WORLD_CACHE_BYTES / sizeof(WorldChunk))
+// Slots of the resident chunk index, a power of two above twice the chunk count
+#define WORLD_CHUNK_SLOTS 256
+#define WORLD_NO_CHUNK 0xFFFF
+// Spill file record: i32 cx | i32 cy | per room: u32 index | u32 last_visit | u8 doors | u8 state
+#define WORLD_CHUNK_RECORD (8 + WORLD_CHUNK_ROOMS * 10)
+// Procedural maze: side of the squares that are each a spanning tree, and the
+// chance (percent) of an extra door on any edge
+#define WORLD_BLOCK 16
+#define WORLD_EXTRA_DOORS 20
+
+// WorldRoom.state bits
+#define WORLD_ROOM_USED     0b00000001
+#define WORLD_ROOM_SEARCHED 0b00000010
+#define WORLD_ROOM_LOOTED   0b00000100
+// bits 4-7: mobs[0..3] killed or fled from
+
+// What is left of a visited room once the player leaves it. The room itself
+// is rebuilt from its generation index (or its coordinates in a procedural
+// world), only the changes are kept.
+typedef struct WorldRoom {
+    int32_t x, y;
+    uint32_t index;      // room number forked from the session Rng
+    uint32_t last_visit; // rooms_walked when the player was last here
+    unsigned char doors;
+    unsigned char state;
+} WorldRoom;
+
+// The rooms of one WORLD_CHUNK square, indexed by their position in it
+typedef struct WorldChunk {
+    int32_t cx, cy;       // chunk coordinates: room coordinates / WORLD_CHUNK, rounded down
+    uint16_t count;       // used rooms
+    uint16_t prev, next;  // LRU list, most recently used first
+    bool dirty;           // changed since it was last written to the spill file
+    WorldRoom rooms[WORLD_CHUNK_ROOMS];
+} WorldChunk;
+
+// Where a spilled chunk is in the spill file
+typedef struct WorldSpilled {
+    int32_t cx, cy;
+    uint32_t record; // record number + 1, 0: empty slot
+    uint16_t count;  // used rooms in the record
+} WorldSpilled;
+
+// Visited rooms keyed by (x, y), in chunks cached with LRU eviction
+typedef struct World {
+    WorldChunk chunks[WORLD_CACHE_CHUNKS];
+    uint16_t slots[WORLD_CHUNK_SLOTS]; // resident chunks by (cx, cy): chunk number + 1, 0: empty
+    uint16_t resident;                 // chunks in use
+    uint16_t head, tail;               // LRU list ends
+    WorldSpilled *spilled;             // spilled chunks by (cx, cy), open addressing
+    uint32_t spilled_capacity;
+    uint32_t spilled_count;
+    uint16_t *record_refs;             // per spill file record: its index entry plus the images
+                                       // reading it (see world_export), 0: free
+    uint32_t *free_records;            // records without references, reused first
+    uint32_t free_count;
+    uint32_t records;                  // records in the spill file
+    uint32_t records_capacity;
+    FILE *spill;
+    char spill_path[96];               // session_<name>.chunks
+    bool forgot;                       // a chunk was dropped, the frontier must be recounted
+    uint64_t chunk_hits;               // chunk lookups served from memory
+    uint64_t chunk_misses;             // chunk lookups read back from the spill file
+    uint64_t chunk_spills;             // chunks written to the spill file
+    uint32_t count;
+    uint32_t version;    // changes whenever a known room or door is added or lost
+    uint32_t next_index; // generation index of the next new room
+    uint32_t frontier;   // open doors of known rooms that lead to unknown ones
+    bool procedural;     // rooms derived from (seed, x, y), only changed ones stored
+    uint64_t seed;       // world seed of procedural rooms
+    unsigned char entered_mobs; // empty mob slots of the current procedural room on entry
+    uint32_t entered_visit;
+} World;
+
+// A world map for a save or a snapshot, taken on the game thread: the rooms
+// of the chunks in memory are copied, spilled chunks are only listed and
+// their records are kept from being overwritten until the image is freed
+typedef struct WorldImage {
+    bool procedural;
+    bool map;            // false: only procedural is known (saves from before maps were saved)
+    bool forgot;
+    bool references;     // spilled chunks are saved as their records in the chunk file
+                         // (snapshots), not as their rooms
+    uint64_t seed;
+    uint32_t next_index;
+    uint32_t frontier;
+    unsigned char entered_mobs;
+    uint32_t entered_visit;
+    uint32_t count;      // stored rooms in rooms
+    WorldRoom *rooms;
+    uint32_t spilled_count;
+    WorldSpilled *spilled; // chunks whose rooms are still in the spill file
+    World *world;        // whose records the image holds, NULL: none
+    int spill;           // descriptor + 1 the records are read with off the game thread, 0: none
+} WorldImage;
+
+void world_reset(World *w, bool procedural, Rng *session);
+WorldRoom *world_find(World *w, int32_t x, int32_t y);
+bool world_doors_at(World *w, int32_t x, int32_t y, unsigned char *doors);
+void world_leave(World *w, int32_t x, int32_t y, Room *r);
+uint32_t world_enter(World *w, int32_t x, int32_t y, Rng *rng, Room *r, uint32_t visit);
+void world_adopt(World *w, int32_t x, int32_t y, uint32_t index, Room *r, uint32_t visit);
+bool world_export(World *w, WorldImage *image);
+bool world_image_read(WorldImage *image, uint32_t i, WorldChunk *c);
+bool world_import(World *w, WorldImage *image);
+void world_image_free(WorldImage *image);
+
+void world_step(int direction, int32_t *x, int32_t *y);
+void world_set_session(const char *session);
+void world_set_spill_session(World *w, const char *session);
+void world_close(World *w, bool keep);
+
+#endif
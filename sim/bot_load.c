@@ -0,0 +1,278 @@
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "bot.h"
+
+/*
+ * Bot load generator.
+ * Runs N bots (see bot.c) at once, each playing its own game headless
+ * through command_handle with the commands a human would type, spread over
+ * a pool of threads. A bot that dies starts a new game at once. Reports
+ * steps (commands) per second, rooms explored per second and how the bots
+ * died, per policy.
+ *
+ * Usage: Dungeons_of_AYBU_bots [--bots <n>] [--threads <n>] [--steps <per bot>]
+ *        [--policy <explorer|fighter|coward|mix>] [--seed <number>]
+ *        [--world <stored|procedural>]
+ * With mix the bots take the policies in turn. Every game of a bot is keyed
+ * by the seed, the bot's number and how often it died before, so the results
+ * don't depend on the thread count.
+ */
+
+// Cold world chunks of bot i go to session_bot_<i>.chunks
+#define BOTS_SESSION_PREFIX "bot_"
+
+// What the bots of one policy did
+typedef struct BotStats {
+    uint64_t bots;
+    uint64_t steps;
+    uint64_t explored;  // rooms entered, counted again in every new game
+    uint64_t kills;
+    uint64_t deaths;
+    uint64_t killers[ENEMY_SKELETON + 1]; // deaths by enemy type
+} BotStats;
+
+// One bot and its game
+typedef struct BotSession {
+    Bot bot;
+    Player *pl;
+    int index;
+    uint64_t lives; // games started
+    uint64_t steps;
+    BotStats stats;
+} BotSession;
+
+static BotSession *bots_sessions;
+static int bots_count = 16;
+static long bots_threads;
+static uint64_t bots_steps = 20000;
+static uint64_t bots_seed = 1;
+static bool bots_mix = true;
+static BotPolicy bots_policy = BOT_EXPLORER;
+
+static double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/* @
+ * bots_new_game: void
+ * --------------------
+ * Starts the next game of a bot, keyed by the run seed, the bot and its life.
+ */
+static void bots_new_game(BotSession *s)
+{
+    bot_new_game(&s->bot);
+    init_game_seeded(s->pl, bots_seed ^ ((uint64_t)s->index << 40) ^ s->lives);
+    s->lives++;
+}
+/* @
+ * bots_end_game: void
+ * --------------------
+ * Books what a bot did in the game that just ended or that the run stops in.
+ */
+static void bots_end_game(BotSession *s)
+{
+    s->stats.explored += s->bot.explored;
+    s->stats.kills += s->pl->mobs_killed;
+    if (!player_check_alive(s->pl))
+    {
+        s->stats.deaths++;
+        s->stats.killers[s->pl->room->mobs[s->pl->warIndex].type]++;
+    }
+}
+/* @
+ * bots_step: void
+ * ----------------
+ * Lets a bot type one command; a dead bot starts over.
+ */
+static void bots_step(BotSession *s)
+{
+    char command[BOT_COMMAND_LENGTH];
+    bot_next_command(&s->bot, s->pl, command, sizeof(command));
+    command_handle(command, s->pl);
+    s->steps++;
+    if (!player_check_alive(s->pl))
+    {
+        bots_end_game(s);
+        bots_new_game(s);
+    }
+}
+/* @
+ * bots_worker: void*
+ * -------------------
+ * Plays every bot whose number is the thread's modulo the thread count, one
+ * command each in turn, until all of them took their steps.
+ */
+static void *bots_worker(void *arg)
+{
+    long thread = (long)(intptr_t)arg;
+    bool busy = true;
+    while (busy)
+    {
+        busy = false;
+        for (int i = (int)thread; i < bots_count; i += (int)bots_threads)
+        {
+            if (bots_sessions[i].steps < bots_steps)
+            {
+                bots_step(&bots_sessions[i]);
+                busy = true;
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    bots_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc)
+        {
+            bots_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            bots_threads = strtol(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            bots_steps = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            bots_seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc
+                 && (strcasecmp(argv[i + 1], "mix") == 0 || bot_policy_find(argv[i + 1], &bots_policy)))
+        {
+            bots_mix = strcasecmp(argv[++i], "mix") == 0;
+        }
+        else if (strcmp(argv[i], "--world") == 0 && i + 1 < argc
+                 && (strcmp(argv[i + 1], "stored") == 0 || strcmp(argv[i + 1], "procedural") == 0))
+        {
+            game_set_procedural(strcmp(argv[++i], "procedural") == 0);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--bots <n>] [--threads <n>] [--steps <per bot>] [--policy <explorer|fighter|coward|mix>] [--seed <number>] [--world <stored|procedural>]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (bots_count < 1)
+    {
+        bots_count = 1;
+    }
+    if (bots_threads < 1)
+    {
+        bots_threads = 1;
+    }
+    if (bots_threads > bots_count)
+    {
+        bots_threads = bots_count;
+    }
+    // nothing is drawn, so the games share no screen state
+    screen_set_backend(&render_backend_null);
+    // names are interned before the threads read them
+    names_init();
+    bots_sessions = (BotSession *)calloc(bots_count, sizeof(BotSession));
+    if (bots_sessions == NULL)
+    {
+        fprintf(stderr, "Out of memory for %d bots.\n", bots_count);
+        return -1;
+    }
+    for (int i = 0; i < bots_count; i++)
+    {
+        BotSession *s = &bots_sessions[i];
+        char session[32];
+        s->index = i;
+        s->pl = (Player *)calloc(1, sizeof(Player));
+        World *world = (World *)calloc(1, sizeof(World));
+        if (s->pl == NULL || world == NULL)
+        {
+            fprintf(stderr, "Out of memory for %d bots.\n", bots_count);
+            return -1;
+        }
+        snprintf(session, sizeof(session), BOTS_SESSION_PREFIX "%d", i);
+        world_set_spill_session(world, session);
+        s->pl->world = world;
+        bot_init(&s->bot, bots_mix ? (BotPolicy)(i % BOT_POLICY_COUNT) : bots_policy, bots_seed, i);
+        bots_new_game(s);
+    }
+
+    double start = now_s();
+    pthread_t *pool = (pthread_t *)malloc(bots_threads * sizeof(pthread_t));
+    long started = 0;
+    while (pool != NULL && started < bots_threads
+           && pthread_create(&pool[started], NULL, bots_worker, (void *)(intptr_t)started) == 0)
+    {
+        started++;
+    }
+    if (started < bots_threads)
+    {
+        // bots of threads that didn't start are played here
+        for (long t = started; t < bots_threads; t++)
+        {
+            bots_worker((void *)(intptr_t)t);
+        }
+    }
+    for (long i = 0; i < started; i++)
+    {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+    double elapsed = now_s() - start;
+    if (elapsed <= 0)
+    {
+        elapsed = 1e-9;
+    }
+
+    BotStats stats[BOT_POLICY_COUNT + 1];
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < bots_count; i++)
+    {
+        BotSession *s = &bots_sessions[i];
+        bots_end_game(s);
+        BotStats *into[2] = { &stats[s->bot.policy], &stats[BOT_POLICY_COUNT] };
+        for (int k = 0; k < 2; k++)
+        {
+            into[k]->bots++;
+            into[k]->steps += s->steps;
+            into[k]->explored += s->stats.explored;
+            into[k]->kills += s->stats.kills;
+            into[k]->deaths += s->stats.deaths;
+            for (int e = 0; e <= ENEMY_SKELETON; e++)
+            {
+                into[k]->killers[e] += s->stats.killers[e];
+            }
+        }
+        world_close(s->pl->world, false);
+        bot_free(&s->bot);
+    }
+
+    printf("%-9s %5s %10s %10s %9s %9s %7s %8s %9s %6s %6s %6s %8s %8s\n", "policy", "bots", "steps", "steps/s", "rooms", "rooms/s",
+           "deaths", "/1k stp", "rooms/lf", "kills", "slime", "zombie", "vampire", "skeleton");
+    for (int p = 0; p <= BOT_POLICY_COUNT; p++)
+    {
+        BotStats *s = &stats[p];
+        if (s->bots == 0)
+        {
+            continue;
+        }
+        printf("%-9s %5llu %10llu %10.0f %9llu %9.0f %7llu %8.2f %9.1f %6llu %6llu %6llu %8llu %8llu\n",
+               p < BOT_POLICY_COUNT ? bot_policy_name((BotPolicy)p) : "all", (unsigned long long)s->bots,
+               (unsigned long long)s->steps, s->steps / elapsed, (unsigned long long)s->explored, s->explored / elapsed,
+               (unsigned long long)s->deaths, s->steps ? 1000.0 * s->deaths / s->steps : 0,
+               (double)s->explored / (s->deaths + s->bots), (unsigned long long)s->kills,
+               (unsigned long long)s->killers[ENEMY_SLIME], (unsigned long long)s->killers[ENEMY_ZOMBIE],
+               (unsigned long long)s->killers[ENEMY_VAMPIRE], (unsigned long long)s->killers[ENEMY_SKELETON]);
+    }
+    printf("%d bots on %ld threads: %llu steps in %.2f s (%.0f steps/s, %.0f rooms explored/s)\n", bots_count, bots_threads,
+           (unsigned long long)stats[BOT_POLICY_COUNT].steps, elapsed, stats[BOT_POLICY_COUNT].steps / elapsed,
+           stats[BOT_POLICY_COUNT].explored / elapsed);
+    return 0;
+}
@@ -0,0 +1,434 @@
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "duel_batch.h"
+
+/*
+ * Headless combat simulator.
+ * Plays millions of fights of player loadouts against every enemy type with
+ * the game's own rules (player_war_round, enemy_create_random,
+ * item_create_random) and no rendering, on a pool of threads, and reports
+ * win rate, turns to kill and damage taken per loadout and enemy.
+ *
+ * Usage: Dungeons_of_AYBU_sim [--fights <per loadout and enemy>] [--threads <n>]
+ *        [--seed <number>] [--action <hit|kick>] [--loadout <bare|item+item...>]...
+ *        [--kernel <auto|avx2|sse2|scalar|game>] [--verify]
+ * Items of a loadout are sword, shield, elixir and general, rolled anew for
+ * every fight; --loadout can be repeated.
+ * Fights are resolved in structure-of-arrays batches by a vector kernel (see
+ * duel_batch.c), or one at a time by player_war_round with --kernel game.
+ * --verify fights every duel with the game's code and with every kernel the
+ * CPU supports and counts the duels whose results differ in any bit.
+ */
+
+#define SIM_MAX_LOADOUTS 16
+#define SIM_ENEMY_TYPES 4
+// Fights handed to a worker at a time, each batch has its own random stream
+#define SIM_BATCH DUEL_BATCH_MAX
+// A fight not over after this many rounds counts as a draw
+#define SIM_MAX_TURNS 1000
+#define SIM_TURN_BINS 128
+// Damage taken per fight is binned in steps of SIM_DAMAGE_STEP
+#define SIM_DAMAGE_STEP 5
+#define SIM_DAMAGE_BINS 128
+
+typedef struct Loadout {
+    const char *name;
+    int items[PLAYER_INV_SIZE];
+    int count;
+} Loadout;
+
+// Results of one loadout against one enemy type
+typedef struct SimStats {
+    uint64_t fights;
+    uint64_t wins;
+    uint64_t draws;
+    uint64_t turns;  // of won fights
+    double taken;    // damage taken, all fights
+    double dealt;    // damage per player hit
+    uint64_t hits;
+    uint64_t turn_bins[SIM_TURN_BINS + 1];     // won fights by rounds, last bin: more
+    uint64_t damage_bins[SIM_DAMAGE_BINS + 1]; // fights by damage taken, last bin: more
+} SimStats;
+
+static const char *sim_default_loadouts[] = {
+    "bare", "sword", "shield", "sword+shield", "sword+sword+shield+shield", "sword+shield+elixir",
+};
+
+static Loadout sim_loadouts[SIM_MAX_LOADOUTS];
+static int sim_loadout_count;
+static SimStats sim_stats[SIM_MAX_LOADOUTS][SIM_ENEMY_TYPES];
+static uint64_t sim_fights = 1000000;
+static uint64_t sim_seed = 1;
+static WarAction sim_action = WAR_HIT;
+static const DuelKernelInfo *sim_kernel; // NULL: player_war_round, one fight at a time
+static bool sim_verify;
+static DuelKernelInfo sim_verify_kernels[4];
+static int sim_verify_count;
+static uint64_t sim_mismatches[4];
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t sim_next_job;
+static uint64_t sim_jobs;
+static uint64_t sim_batches; // per loadout and enemy
+
+static double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/* @
+ * sim_parse_loadout: bool
+ * ------------------------
+ * Reads a loadout like "sword+shield" ("bare" for none).
+ */
+static bool sim_parse_loadout(const char *spec, Loadout *l)
+{
+    static const char *items[] = { "", "sword", "shield", "elixir", "general" };
+    memset(l, 0, sizeof(*l));
+    l->name = spec;
+    if (strcasecmp(spec, "bare") == 0)
+    {
+        return true;
+    }
+    const char *p = spec;
+    while (*p != '\0')
+    {
+        size_t length = strcspn(p, "+");
+        int type = ITEM_NONE;
+        for (int i = ITEM_SWORD; i <= ITEM_GENERAL; i++)
+        {
+            if (strlen(items[i]) == length && strncasecmp(p, items[i], length) == 0)
+            {
+                type = i;
+            }
+        }
+        if (type == ITEM_NONE || l->count == PLAYER_INV_SIZE)
+        {
+            return false;
+        }
+        l->items[l->count++] = type;
+        p += length;
+        if (*p == '+')
+        {
+            p++;
+        }
+    }
+    return l->count > 0;
+}
+/* @
+ * sim_setup: void
+ * ----------------
+ * Rolls a player with the loadout's items and an enemy of the given type the
+ * way the game does (re-rolling until the type matches).
+ */
+static void sim_setup(Player *pl, const Loadout *l, EnemyType type, Enemy *e)
+{
+    memset(pl->inventory, 0, sizeof(pl->inventory));
+    for (int i = 0; i < l->count; i++)
+    {
+        do
+        {
+            item_create_random(&pl->inventory[i], &pl->war_rng);
+        } while (pl->inventory[i].type != l->items[i]);
+    }
+    player_calculate_stats(pl);
+    do
+    {
+        enemy_create_random(e, &pl->war_rng);
+    } while (e->type != type);
+}
+/* @
+ * sim_record: void
+ * -----------------
+ * Books the result of one fight.
+ */
+static void sim_record(SimStats *stats, float start, const DuelResult *r)
+{
+    float taken = start - r->p_health;
+    stats->fights++;
+    stats->taken += taken;
+    stats->dealt += r->dealt;
+    stats->hits += r->turns;
+    int bin = (int)(taken / SIM_DAMAGE_STEP);
+    stats->damage_bins[bin < 0 ? 0 : (bin > SIM_DAMAGE_BINS ? SIM_DAMAGE_BINS : bin)]++;
+    if (r->outcome == WAR_ENEMY_KILLED)
+    {
+        stats->wins++;
+        stats->turns += r->turns;
+        stats->turn_bins[r->turns > SIM_TURN_BINS ? SIM_TURN_BINS : r->turns]++;
+    }
+    else if (r->outcome == WAR_EXCHANGED)
+    {
+        stats->draws++;
+    }
+}
+static void sim_merge(SimStats *into, const SimStats *from)
+{
+    into->fights += from->fights;
+    into->wins += from->wins;
+    into->draws += from->draws;
+    into->turns += from->turns;
+    into->taken += from->taken;
+    into->dealt += from->dealt;
+    into->hits += from->hits;
+    for (int i = 0; i <= SIM_TURN_BINS; i++)
+    {
+        into->turn_bins[i] += from->turn_bins[i];
+    }
+    for (int i = 0; i <= SIM_DAMAGE_BINS; i++)
+    {
+        into->damage_bins[i] += from->damage_bins[i];
+    }
+}
+// What a worker needs for one batch of fights
+typedef struct SimWork {
+    Player pl;                       // rolls the batch's players and enemies
+    Player players[SIM_BATCH];
+    Enemy enemies[SIM_BATCH];
+    Rng rngs[SIM_BATCH];             // each fight's own rolls
+    DuelResult results[SIM_BATCH];
+    DuelResult checks[SIM_BATCH];    // --verify: the same fights by a kernel
+    DuelBatch batch;
+    Room room;
+    SimStats stats;
+} SimWork;
+
+/* @
+ * sim_fight_batch: void
+ * ----------------------
+ * Fights the set up duels with the game's code or with a kernel.
+ */
+static void sim_fight_batch(SimWork *w, int count, const DuelKernelInfo *kernel, DuelResult *results)
+{
+    if (kernel == NULL)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Player pl = w->players[i];
+            duel_fight_scalar(&pl, &w->room, &w->enemies[i], &w->rngs[i], sim_action, SIM_MAX_TURNS, &results[i]);
+        }
+        return;
+    }
+    w->batch.count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        duel_batch_add(&w->batch, &w->players[i], &w->enemies[i], &w->rngs[i]);
+    }
+    duel_batch_run(&w->batch, kernel->kernel, sim_action, SIM_MAX_TURNS, results);
+}
+/* @
+ * sim_worker: void*
+ * ------------------
+ * Thread pool worker: takes batches until none are left. A batch's random
+ * streams depend only on its number, so results don't depend on the thread
+ * count, on which thread ran it or on the kernel.
+ */
+static void *sim_worker(void *arg)
+{
+    (void)arg;
+    SimWork *w = (SimWork *)calloc(1, sizeof(SimWork));
+    while (w != NULL)
+    {
+        pthread_mutex_lock(&sim_mutex);
+        uint64_t job = sim_next_job++;
+        pthread_mutex_unlock(&sim_mutex);
+        if (job >= sim_jobs)
+        {
+            break;
+        }
+        uint64_t cell = job / sim_batches, batch = job % sim_batches;
+        const Loadout *l = &sim_loadouts[cell / SIM_ENEMY_TYPES];
+        EnemyType type = (EnemyType)(cell % SIM_ENEMY_TYPES + ENEMY_SLIME);
+        int count = (int)(sim_fights - batch * SIM_BATCH < SIM_BATCH ? sim_fights - batch * SIM_BATCH : SIM_BATCH);
+
+        rng_seed(&w->pl.war_rng, sim_seed, job);
+        for (int i = 0; i < count; i++)
+        {
+            sim_setup(&w->pl, l, type, &w->enemies[i]);
+            w->players[i] = w->pl;
+            rng_seed(&w->rngs[i], sim_seed ^ 0x9E3779B97F4A7C15ull, job * SIM_BATCH + i);
+        }
+        sim_fight_batch(w, count, sim_verify ? NULL : sim_kernel, w->results);
+
+        uint64_t mismatches[4] = { 0 };
+        for (int k = 0; k < sim_verify_count; k++)
+        {
+            sim_fight_batch(w, count, &sim_verify_kernels[k], w->checks);
+            for (int i = 0; i < count; i++)
+            {
+                DuelResult *a = &w->results[i], *b = &w->checks[i];
+                if (a->outcome != b->outcome || a->turns != b->turns || memcmp(&a->p_health, &b->p_health, sizeof(float)) != 0
+                    || memcmp(&a->e_health, &b->e_health, sizeof(float)) != 0 || memcmp(&a->dealt, &b->dealt, sizeof(double)) != 0)
+                {
+                    mismatches[k]++;
+                }
+            }
+        }
+
+        memset(&w->stats, 0, sizeof(w->stats));
+        for (int i = 0; i < count; i++)
+        {
+            sim_record(&w->stats, w->players[i].health, &w->results[i]);
+        }
+        pthread_mutex_lock(&sim_mutex);
+        sim_merge(&sim_stats[cell / SIM_ENEMY_TYPES][cell % SIM_ENEMY_TYPES], &w->stats);
+        for (int k = 0; k < sim_verify_count; k++)
+        {
+            sim_mismatches[k] += mismatches[k];
+        }
+        pthread_mutex_unlock(&sim_mutex);
+    }
+    free(w);
+    return NULL;
+}
+/* @
+ * sim_percentile: double
+ * -----------------------
+ * Value below which a share p of a histogram's samples lie.
+ */
+static double sim_percentile(const uint64_t *bins, int count, double step, double p)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += bins[i];
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < count; i++)
+    {
+        seen += bins[i];
+        if (total > 0 && seen >= p * total)
+        {
+            return i * step;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    sim_kernel = duel_kernel_find("auto");
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--fights") == 0 && i + 1 < argc)
+        {
+            sim_fights = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = strtol(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            sim_seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--action") == 0 && i + 1 < argc
+                 && (strcasecmp(argv[i + 1], "hit") == 0 || strcasecmp(argv[i + 1], "kick") == 0))
+        {
+            sim_action = strcasecmp(argv[++i], "kick") == 0 ? WAR_KICK : WAR_HIT;
+        }
+        else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc
+                 && (strcasecmp(argv[i + 1], "game") == 0 || duel_kernel_find(argv[i + 1]) != NULL))
+        {
+            i++;
+            sim_kernel = strcasecmp(argv[i], "game") == 0 ? NULL : duel_kernel_find(argv[i]);
+        }
+        else if (strcmp(argv[i], "--verify") == 0)
+        {
+            sim_verify = true;
+        }
+        else if (strcmp(argv[i], "--loadout") == 0 && i + 1 < argc && sim_loadout_count < SIM_MAX_LOADOUTS
+                 && sim_parse_loadout(argv[i + 1], &sim_loadouts[sim_loadout_count]))
+        {
+            sim_loadout_count++;
+            i++;
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--fights <n>] [--threads <n>] [--seed <number>] [--action <hit|kick>] [--loadout <bare|sword+shield+elixir+general...>]... [--kernel <auto|avx2|sse2|scalar|game>] [--verify]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (sim_loadout_count == 0)
+    {
+        for (size_t i = 0; i < sizeof(sim_default_loadouts) / sizeof(sim_default_loadouts[0]); i++)
+        {
+            sim_parse_loadout(sim_default_loadouts[i], &sim_loadouts[sim_loadout_count++]);
+        }
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    // item names are picked from the interned table
+    names_init();
+    if (sim_verify)
+    {
+        sim_verify_count = duel_kernels(sim_verify_kernels, 4);
+    }
+    sim_batches = (sim_fights + SIM_BATCH - 1) / SIM_BATCH;
+    sim_jobs = sim_batches * sim_loadout_count * SIM_ENEMY_TYPES;
+
+    double start = now_s();
+    pthread_t *pool = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    long started = 0;
+    while (pool != NULL && started < threads && pthread_create(&pool[started], NULL, sim_worker, NULL) == 0)
+    {
+        started++;
+    }
+    if (started == 0)
+    {
+        sim_worker(NULL);
+    }
+    for (long i = 0; i < started; i++)
+    {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+    double elapsed = now_s() - start;
+
+    printf("%-26s %-9s %7s %6s %6s %5s %5s %5s %7s %6s %6s %6s\n", "loadout", "enemy", "win%", "draw%", "turns", "p50", "p90", "max", "dmg/hit",
+           "taken", "p50", "p90");
+    uint64_t total = 0;
+    for (int l = 0; l < sim_loadout_count; l++)
+    {
+        for (int e = 0; e < SIM_ENEMY_TYPES; e++)
+        {
+            SimStats *s = &sim_stats[l][e];
+            uint64_t fights = s->fights ? s->fights : 1;
+            uint64_t wins = s->wins ? s->wins : 1;
+            int max = 0;
+            for (int i = 0; i <= SIM_TURN_BINS; i++)
+            {
+                if (s->turn_bins[i] != 0)
+                {
+                    max = i;
+                }
+            }
+            total += s->fights;
+            printf("%-26s %-9s %7.2f %6.2f %6.2f %5.0f %5.0f %4d%s %7.2f %6.1f %6.0f %6.0f\n", sim_loadouts[l].name,
+                   enemy_get_simple_name((EnemyType)(e + ENEMY_SLIME)), 100.0 * s->wins / fights, 100.0 * s->draws / fights,
+                   (double)s->turns / wins, sim_percentile(s->turn_bins, SIM_TURN_BINS + 1, 1, 0.5),
+                   sim_percentile(s->turn_bins, SIM_TURN_BINS + 1, 1, 0.9), max, max == SIM_TURN_BINS ? "+" : " ",
+                   s->hits ? s->dealt / s->hits : 0, s->taken / fights,
+                   sim_percentile(s->damage_bins, SIM_DAMAGE_BINS + 1, SIM_DAMAGE_STEP, 0.5),
+                   sim_percentile(s->damage_bins, SIM_DAMAGE_BINS + 1, SIM_DAMAGE_STEP, 0.9));
+        }
+    }
+    printf("%llu fights on %ld threads with %s in %.2f s (%.1f M fights/s)\n", (unsigned long long)total, started ? started : 1,
+           sim_verify ? "every kernel" : (sim_kernel != NULL ? sim_kernel->name : "the game's code"), elapsed,
+           total / (elapsed > 0 ? elapsed : 1) / 1e6);
+    bool mismatch = false;
+    for (int k = 0; k < sim_verify_count; k++)
+    {
+        printf("verify %-6s: %llu of %llu fights differ from the game's code\n", sim_verify_kernels[k].name,
+               (unsigned long long)sim_mismatches[k], (unsigned long long)total);
+        mismatch |= sim_mismatches[k] != 0;
+    }
+    return mismatch ? 1 : 0;
+}
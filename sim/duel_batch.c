@@ -0,0 +1,341 @@
+#include "duel_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DUEL_X86 1
+#endif
+
+/*
+ * Duel batches for the combat simulator.
+ * The arithmetic of a fight round (crit rolls, damage, the enemy's double
+ * health loss and the player's defence, see player_war_round) is done for
+ * a whole batch at once by a kernel: plain C, SSE2 (4 lanes) or AVX2
+ * (8 lanes). Rolls are drawn per lane from the duel's own generator before
+ * the kernel runs, in the order the game draws them, so every kernel gives
+ * bit-for-bit the results of the game's own scalar code.
+ */
+
+/* @
+ * duel_batch_add: void
+ * ---------------------
+ * Adds a duel as the next lane of the batch.
+ *
+ * Parameters:
+ * - b: DuelBatch* - The batch, with room for one more duel.
+ * - pl: const Player* - The player, stats already calculated from the inventory.
+ * - e: const Enemy* - The enemy.
+ * - rng: const Rng* - The duel's generator, copied.
+ */
+void duel_batch_add(DuelBatch *b, const Player *pl, const Enemy *e, const Rng *rng)
+{
+    int i = b->count++;
+    b->p_health[i] = pl->health;
+    b->p_strength[i] = pl->strength;
+    b->p_defence[i] = pl->defence;
+    b->p_crit_rate[i] = pl->crit_rate;
+    b->p_crit_chance[i] = pl->crit_chance;
+    b->e_health[i] = e->health;
+    b->e_damage[i] = e->damage;
+    b->e_crit_rate[i] = e->crit_rate;
+    b->e_crit_chance[i] = e->crit_chance;
+    b->dealt_sum[i] = 0;
+    b->turns[i] = 0;
+    b->id[i] = i;
+    b->rng[i] = *rng;
+}
+/* @
+ * duel_lanes_scalar: void
+ * ------------------------
+ * The round for lanes [from, to), written like player_attack, enemy_get_hit,
+ * enemy_attack and player_get_hit. Also the tail of the vector kernels.
+ */
+static void duel_lanes_scalar(DuelBatch *b, int multiplier, int from, int to)
+{
+    for (int i = from; i < to; i++)
+    {
+        float damage;
+        if (b->p_roll[i] * multiplier <= b->p_crit_chance[i] * 100)
+            damage = b->p_strength[i] * b->p_crit_rate[i] * multiplier;
+        else
+            damage = b->p_strength[i];
+        b->dealt[i] = damage;
+        // applied twice, like the game does
+        b->e_health[i] -= damage;
+        b->e_health[i] -= damage;
+        if (b->e_health[i] > 0)
+        {
+            float e_damage;
+            if (b->e_roll[i] <= b->e_crit_chance[i] * 100)
+                e_damage = b->e_damage[i] * b->e_crit_rate[i];
+            else
+                e_damage = b->e_damage[i];
+            b->p_health[i] += (0.25 * b->p_defence[i] - e_damage);
+        }
+    }
+}
+static void duel_kernel_scalar(DuelBatch *b, int multiplier)
+{
+    duel_lanes_scalar(b, multiplier, 0, b->count);
+}
+
+#ifdef DUEL_X86
+/* @
+ * duel_kernel_sse2: void
+ * -----------------------
+ * The round for 4 lanes at a time. Comparisons become masks that select
+ * between the normal and the critical damage; the player's health is
+ * updated in double precision like player_get_hit does.
+ */
+static void duel_kernel_sse2(DuelBatch *b, int multiplier)
+{
+    const __m128 mult = _mm_set1_ps((float)multiplier);
+    const __m128 hundred = _mm_set1_ps(100.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128d quarter = _mm_set1_pd(0.25);
+    int i = 0;
+    for (; i + 4 <= b->count; i += 4)
+    {
+        __m128 roll = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&b->p_roll[i])), mult);
+        __m128 crit = _mm_cmple_ps(roll, _mm_mul_ps(_mm_loadu_ps(&b->p_crit_chance[i]), hundred));
+        __m128 strength = _mm_loadu_ps(&b->p_strength[i]);
+        __m128 crit_damage = _mm_mul_ps(_mm_mul_ps(strength, _mm_loadu_ps(&b->p_crit_rate[i])), mult);
+        __m128 damage = _mm_or_ps(_mm_and_ps(crit, crit_damage), _mm_andnot_ps(crit, strength));
+        _mm_storeu_ps(&b->dealt[i], damage);
+
+        __m128 e_health = _mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(&b->e_health[i]), damage), damage);
+        _mm_storeu_ps(&b->e_health[i], e_health);
+        __m128 alive = _mm_cmpgt_ps(e_health, zero);
+
+        __m128 e_roll = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&b->e_roll[i]));
+        __m128 e_crit = _mm_cmple_ps(e_roll, _mm_mul_ps(_mm_loadu_ps(&b->e_crit_chance[i]), hundred));
+        __m128 e_base = _mm_loadu_ps(&b->e_damage[i]);
+        __m128 e_crit_damage = _mm_mul_ps(e_base, _mm_loadu_ps(&b->e_crit_rate[i]));
+        __m128 e_damage = _mm_or_ps(_mm_and_ps(e_crit, e_crit_damage), _mm_andnot_ps(e_crit, e_base));
+
+        __m128 health = _mm_loadu_ps(&b->p_health[i]);
+        __m128 defence = _mm_loadu_ps(&b->p_defence[i]);
+        __m128d lo = _mm_add_pd(_mm_cvtps_pd(health),
+                                _mm_sub_pd(_mm_mul_pd(quarter, _mm_cvtps_pd(defence)), _mm_cvtps_pd(e_damage)));
+        __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(health, health)),
+                                _mm_sub_pd(_mm_mul_pd(quarter, _mm_cvtps_pd(_mm_movehl_ps(defence, defence))),
+                                           _mm_cvtps_pd(_mm_movehl_ps(e_damage, e_damage))));
+        __m128 hit = _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+        _mm_storeu_ps(&b->p_health[i], _mm_or_ps(_mm_and_ps(alive, hit), _mm_andnot_ps(alive, health)));
+    }
+    duel_lanes_scalar(b, multiplier, i, b->count);
+}
+/* @
+ * duel_kernel_avx2: void
+ * -----------------------
+ * The round for 8 lanes at a time, see duel_kernel_sse2. Only used when the
+ * CPU has AVX2.
+ */
+__attribute__((target("avx2")))
+static void duel_kernel_avx2(DuelBatch *b, int multiplier)
+{
+    const __m256 mult = _mm256_set1_ps((float)multiplier);
+    const __m256 hundred = _mm256_set1_ps(100.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256d quarter = _mm256_set1_pd(0.25);
+    int i = 0;
+    for (; i + 8 <= b->count; i += 8)
+    {
+        __m256 roll = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&b->p_roll[i])), mult);
+        __m256 crit = _mm256_cmp_ps(roll, _mm256_mul_ps(_mm256_loadu_ps(&b->p_crit_chance[i]), hundred), _CMP_LE_OQ);
+        __m256 strength = _mm256_loadu_ps(&b->p_strength[i]);
+        __m256 crit_damage = _mm256_mul_ps(_mm256_mul_ps(strength, _mm256_loadu_ps(&b->p_crit_rate[i])), mult);
+        __m256 damage = _mm256_blendv_ps(strength, crit_damage, crit);
+        _mm256_storeu_ps(&b->dealt[i], damage);
+
+        __m256 e_health = _mm256_sub_ps(_mm256_sub_ps(_mm256_loadu_ps(&b->e_health[i]), damage), damage);
+        _mm256_storeu_ps(&b->e_health[i], e_health);
+        __m256 alive = _mm256_cmp_ps(e_health, zero, _CMP_GT_OQ);
+
+        __m256 e_roll = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&b->e_roll[i]));
+        __m256 e_crit = _mm256_cmp_ps(e_roll, _mm256_mul_ps(_mm256_loadu_ps(&b->e_crit_chance[i]), hundred), _CMP_LE_OQ);
+        __m256 e_base = _mm256_loadu_ps(&b->e_damage[i]);
+        __m256 e_damage = _mm256_blendv_ps(e_base, _mm256_mul_ps(e_base, _mm256_loadu_ps(&b->e_crit_rate[i])), e_crit);
+
+        __m256 health = _mm256_loadu_ps(&b->p_health[i]);
+        __m256 defence = _mm256_loadu_ps(&b->p_defence[i]);
+        __m256d lo = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(health)),
+                                   _mm256_sub_pd(_mm256_mul_pd(quarter, _mm256_cvtps_pd(_mm256_castps256_ps128(defence))),
+                                                 _mm256_cvtps_pd(_mm256_castps256_ps128(e_damage))));
+        __m256d hi = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(health, 1)),
+                                   _mm256_sub_pd(_mm256_mul_pd(quarter, _mm256_cvtps_pd(_mm256_extractf128_ps(defence, 1))),
+                                                 _mm256_cvtps_pd(_mm256_extractf128_ps(e_damage, 1))));
+        __m256 hit = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+        _mm256_storeu_ps(&b->p_health[i], _mm256_blendv_ps(health, hit, alive));
+    }
+    duel_lanes_scalar(b, multiplier, i, b->count);
+}
+#endif
+
+/* @
+ * duel_kernels: int
+ * ------------------
+ * Lists the kernels this CPU can run, the fastest last.
+ *
+ * Parameters:
+ * - kernels: DuelKernelInfo* - Receives up to max kernels.
+ * - max: int - Room in kernels.
+ *
+ * Returns:
+ * - The number of kernels listed.
+ */
+int duel_kernels(DuelKernelInfo *kernels, int max)
+{
+    int count = 0;
+    if (count < max)
+        kernels[count++] = (DuelKernelInfo){ "scalar", duel_kernel_scalar };
+#ifdef DUEL_X86
+    if (count < max)
+        kernels[count++] = (DuelKernelInfo){ "sse2", duel_kernel_sse2 };
+    __builtin_cpu_init();
+    if (count < max && __builtin_cpu_supports("avx2"))
+        kernels[count++] = (DuelKernelInfo){ "avx2", duel_kernel_avx2 };
+#endif
+    return count;
+}
+/* @
+ * duel_kernel_find: const DuelKernelInfo*
+ * ----------------------------------------
+ * Looks up a kernel by name; "auto" is the fastest one this CPU can run.
+ *
+ * Returns:
+ * - The kernel, or NULL if it is unknown or not supported here.
+ */
+const DuelKernelInfo *duel_kernel_find(const char *name)
+{
+    static DuelKernelInfo kernels[4];
+    static int count;
+    if (count == 0)
+    {
+        count = duel_kernels(kernels, 4);
+    }
+    if (strcasecmp(name, "auto") == 0)
+    {
+        return &kernels[count - 1];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (strcasecmp(name, kernels[i].name) == 0)
+        {
+            return &kernels[i];
+        }
+    }
+    return NULL;
+}
+/* @
+ * duel_lane_move: void
+ * ---------------------
+ * Copies lane from into lane to, used to close the gap a finished duel leaves.
+ */
+static void duel_lane_move(DuelBatch *b, int to, int from)
+{
+    b->p_health[to] = b->p_health[from];
+    b->p_strength[to] = b->p_strength[from];
+    b->p_defence[to] = b->p_defence[from];
+    b->p_crit_rate[to] = b->p_crit_rate[from];
+    b->p_crit_chance[to] = b->p_crit_chance[from];
+    b->e_health[to] = b->e_health[from];
+    b->e_damage[to] = b->e_damage[from];
+    b->e_crit_rate[to] = b->e_crit_rate[from];
+    b->e_crit_chance[to] = b->e_crit_chance[from];
+    b->dealt[to] = b->dealt[from];
+    b->dealt_sum[to] = b->dealt_sum[from];
+    b->turns[to] = b->turns[from];
+    b->id[to] = b->id[from];
+    b->rng[to] = b->rng[from];
+}
+/* @
+ * duel_batch_run: void
+ * ---------------------
+ * Fights every duel of the batch to its end, one kernel call per round.
+ *
+ * Parameters:
+ * - b: DuelBatch* - The batch, emptied on return.
+ * - kernel: DuelKernel - Kernel resolving the rounds.
+ * - action: WarAction - WAR_HIT or WAR_KICK, for every round.
+ * - max_turns: int - Rounds after which an undecided duel is given up.
+ * - results: DuelResult* - Receives the result of duel i (in the order
+ *   they were added) at index i.
+ */
+void duel_batch_run(DuelBatch *b, DuelKernel kernel, WarAction action, int max_turns, DuelResult *results)
+{
+    int multiplier = action == WAR_KICK ? 2 : 1;
+    while (b->count > 0)
+    {
+        // the player's roll first, then the enemy's, as in player_war_round;
+        // an enemy killed this round just leaves its roll unused
+        for (int i = 0; i < b->count; i++)
+        {
+            b->p_roll[i] = rng_range(&b->rng[i], 100) + 1;
+            b->e_roll[i] = rng_range(&b->rng[i], 100) + 1;
+        }
+        kernel(b, multiplier);
+
+        for (int i = 0; i < b->count; i++)
+        {
+            b->dealt_sum[i] += b->dealt[i];
+            b->turns[i]++;
+            WarOutcome outcome = WAR_EXCHANGED;
+            if (b->e_health[i] <= 0)
+                outcome = WAR_ENEMY_KILLED;
+            else if (b->p_health[i] <= 0)
+                outcome = WAR_PLAYER_DIED;
+            else if (b->turns[i] < max_turns)
+                continue;
+
+            DuelResult *r = &results[b->id[i]];
+            r->outcome = outcome;
+            r->turns = b->turns[i];
+            r->p_health = b->p_health[i];
+            r->e_health = b->e_health[i];
+            r->dealt = b->dealt_sum[i];
+            duel_lane_move(b, i, --b->count);
+            i--;
+        }
+    }
+}
+/* @
+ * duel_fight_scalar: void
+ * ------------------------
+ * Fights one duel with the game's own player_war_round, the reference the
+ * kernels are checked against.
+ *
+ * Parameters:
+ * - pl: Player* - The player, stats already calculated; changed by the fight.
+ * - room: Room* - Scratch room the enemy is put in.
+ * - e: const Enemy* - The enemy.
+ * - rng: const Rng* - The duel's generator, copied.
+ * - action: WarAction - WAR_HIT or WAR_KICK, for every round.
+ * - max_turns: int - Rounds after which an undecided duel is given up.
+ * - result: DuelResult* - Receives the result.
+ */
+void duel_fight_scalar(Player *pl, Room *room, const Enemy *e, const Rng *rng, WarAction action, int max_turns, DuelResult *result)
+{
+    room->mobs[0] = *e;
+    pl->room = room;
+    pl->warIndex = 0;
+    pl->onWar = true;
+    pl->war_rng = *rng;
+    double dealt_sum = 0;
+    int turns = 0;
+    WarOutcome outcome = WAR_EXCHANGED;
+    float e_health = e->health;
+    while (outcome == WAR_EXCHANGED && turns < max_turns)
+    {
+        float dealt, taken;
+        outcome = player_war_round(pl, action, &dealt, &taken);
+        // the round clears a killed enemy, keep what its health came to
+        e_health = outcome == WAR_ENEMY_KILLED ? e_health - dealt - dealt : room->mobs[0].health;
+        dealt_sum += dealt;
+        turns++;
+    }
+    result->outcome = outcome;
+    result->turns = turns;
+    result->p_health = pl->health;
+    result->e_health = e_health;
+    result->dealt = dealt_sum;
+}
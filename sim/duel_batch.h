@@ -0,0 +1,59 @@
+#ifndef DUEL_BATCH_H
+#define DUEL_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rng.h"
+#include "player.h"
+
+// Duels resolved together, the lanes of one kernel call
+#define DUEL_BATCH_MAX 16384
+
+// Structure-of-arrays batch of player-against-enemy duels. The first count
+// lanes are the duels still being fought; finished ones are swapped out.
+typedef struct DuelBatch {
+    int count;
+    float p_health[DUEL_BATCH_MAX];
+    float p_strength[DUEL_BATCH_MAX];
+    float p_defence[DUEL_BATCH_MAX];
+    float p_crit_rate[DUEL_BATCH_MAX];
+    float p_crit_chance[DUEL_BATCH_MAX];
+    float e_health[DUEL_BATCH_MAX];
+    float e_damage[DUEL_BATCH_MAX];
+    float e_crit_rate[DUEL_BATCH_MAX];
+    float e_crit_chance[DUEL_BATCH_MAX];
+    int32_t p_roll[DUEL_BATCH_MAX]; // this round's rolls, 1-100
+    int32_t e_roll[DUEL_BATCH_MAX];
+    float dealt[DUEL_BATCH_MAX];    // this round's player damage
+    double dealt_sum[DUEL_BATCH_MAX];
+    int32_t turns[DUEL_BATCH_MAX];
+    int32_t id[DUEL_BATCH_MAX];     // duel number the lane holds
+    Rng rng[DUEL_BATCH_MAX];        // the duel's own rolls
+} DuelBatch;
+
+// How a duel ended, by duel number
+typedef struct DuelResult {
+    WarOutcome outcome; // WAR_EXCHANGED: still undecided after the turn limit
+    int turns;
+    float p_health;
+    float e_health;
+    double dealt; // sum of the player's damage per round
+} DuelResult;
+
+// One round of every lane: player hit or kick, enemy answer if it survived
+typedef void (*DuelKernel)(DuelBatch *b, int multiplier);
+
+typedef struct DuelKernelInfo {
+    const char *name;
+    DuelKernel kernel;
+} DuelKernelInfo;
+
+void duel_batch_add(DuelBatch *b, const Player *pl, const Enemy *e, const Rng *rng);
+void duel_batch_run(DuelBatch *b, DuelKernel kernel, WarAction action, int max_turns, DuelResult *results);
+void duel_fight_scalar(Player *pl, Room *room, const Enemy *e, const Rng *rng, WarAction action, int max_turns, DuelResult *result);
+
+int duel_kernels(DuelKernelInfo *kernels, int max);
+const DuelKernelInfo *duel_kernel_find(const char *name);
+
+#endif
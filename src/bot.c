@@ -0,0 +1,214 @@
+#include "bot.h"
+
+// Share of its health below which an explorer runs from a fight
+#define BOT_FLEE_HEALTH 0.3f
+
+static const char *bot_policy_names[BOT_POLICY_COUNT] = { "explorer", "fighter", "coward" };
+// Argument of move and attack for each direction, the numbering of doors and mobs
+static const char *bot_directions[4] = { "left", "down", "right", "up" };
+
+/* @
+ * bot_init: void
+ * ---------------
+ * Sets up a bot with no rooms visited yet.
+ *
+ * Parameters:
+ * - b: Bot* - The bot, its old contents are ignored.
+ * - policy: BotPolicy - How it plays.
+ * - seed, stream: uint64_t - Key of its own random choices.
+ */
+void bot_init(Bot *b, BotPolicy policy, uint64_t seed, uint64_t stream) {
+    memset(b, 0, sizeof(*b));
+    b->policy = policy;
+    rng_seed(&b->rng, seed, stream);
+}
+/* @
+ * bot_new_game: void
+ * -------------------
+ * Forgets the rooms of the last game, for a bot that starts over.
+ */
+void bot_new_game(Bot *b) {
+    if (b->visits != NULL) {
+        memset(b->visits, 0, b->capacity * sizeof(BotVisit));
+    }
+    b->explored = 0;
+    b->moves = 0;
+}
+void bot_free(Bot *b) {
+    free(b->visits);
+    b->visits = NULL;
+    b->capacity = 0;
+}
+/* @
+ * bot_slot: BotVisit*
+ * --------------------
+ * Finds the visit of a room, or the empty slot where it goes.
+ */
+static BotVisit *bot_slot(Bot *b, int32_t x, int32_t y) {
+    uint64_t h = ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    uint32_t i = (uint32_t)h & (b->capacity - 1);
+    while (b->visits[i].last != 0 && (b->visits[i].x != x || b->visits[i].y != y)) {
+        i = (i + 1) & (b->capacity - 1);
+    }
+    return &b->visits[i];
+}
+/* @
+ * bot_last_visit: uint32_t
+ * -------------------------
+ * When the bot was last in a room.
+ *
+ * Returns:
+ * - Its move count then + 1, or 0 if it has never been there.
+ */
+static uint32_t bot_last_visit(Bot *b, int32_t x, int32_t y) {
+    return b->capacity == 0 ? 0 : bot_slot(b, x, y)->last;
+}
+/* @
+ * bot_visit: void
+ * ----------------
+ * Notes that the bot is in a room now, growing the table (kept at most half
+ * full) for a room it hasn't been in before.
+ */
+static void bot_visit(Bot *b, int32_t x, int32_t y) {
+    if (bot_last_visit(b, x, y) == 0 && (b->explored + 1) * 2 > b->capacity) {
+        uint32_t capacity = b->capacity == 0 ? 256 : b->capacity * 2;
+        BotVisit *grown = (BotVisit*)calloc(capacity, sizeof(BotVisit));
+        if (grown == NULL) {
+            return;
+        }
+        BotVisit *old = b->visits;
+        uint32_t old_capacity = b->capacity;
+        b->visits = grown;
+        b->capacity = capacity;
+        for (uint32_t i = 0; i < old_capacity; i++) {
+            if (old[i].last != 0) {
+                *bot_slot(b, old[i].x, old[i].y) = old[i];
+            }
+        }
+        free(old);
+    }
+    BotVisit *v = bot_slot(b, x, y);
+    if (v->last == 0) {
+        v->x = x;
+        v->y = y;
+        b->explored++;
+    }
+    v->last = b->moves + 1;
+}
+/* @
+ * bot_choose_door: int
+ * ---------------------
+ * Picks the door to leave through. A fighter takes any open door; an explorer
+ * or a coward the one to the room it has seen least recently (unseen first),
+ * an unguarded one before a guarded one to an equally old room. Ties are
+ * broken at random.
+ *
+ * Returns:
+ * - The direction, or -1 if the room has no open door.
+ */
+static int bot_choose_door(Bot *b, Player *pl) {
+    int best = -1;
+    uint64_t best_key = 0;
+    int ties = 0;
+    for (int d = 0; d < 4; d++) {
+        if (!(pl->room->doors & (1 << d))) {
+            continue;
+        }
+        uint64_t key = 0;
+        if (b->policy != BOT_FIGHTER) {
+            int32_t x = pl->x, y = pl->y;
+            world_step(d, &x, &y);
+            key = ((uint64_t)bot_last_visit(b, x, y) << 1) | (pl->room->mobs[d].type != ENEMY_NONE);
+        }
+        if (best == -1 || key < best_key) {
+            best = d;
+            best_key = key;
+            ties = 1;
+        } else if (key == best_key && rng_range(&b->rng, ++ties) == 0) {
+            best = d;
+        }
+    }
+    return best;
+}
+/* @
+ * bot_next_command: void
+ * -----------------------
+ * Decides what the bot types next, from what the game shows: the current
+ * room's doors, enemies (after a look) and item, and the player's health.
+ *
+ * Parameters:
+ * - b: Bot* - The bot.
+ * - pl: Player* - Its game, alive. Only read.
+ * - command: char* - Receives the command line, as it would be typed.
+ * - size: size_t - Size of command, BOT_COMMAND_LENGTH is enough.
+ *
+ * Notes:
+ * - In a fight an explorer hits and flees when low on health, a fighter
+ *   kicks (more damage on average than a hit) and a coward flees.
+ * - Otherwise every new room is looked at first, then its item picked up if
+ *   the inventory takes it, then a fighter attacks every enemy in it, and
+ *   finally the bot moves on, attacking the enemy in front of its door first.
+ * - A coward only starts a fight to get past, and flees it at once: a fled
+ *   enemy is gone from the room too.
+ */
+void bot_next_command(Bot *b, Player *pl, char *command, size_t size) {
+    Room *r = pl->room;
+    bot_visit(b, pl->x, pl->y);
+    if (pl->onWar) {
+        const char *action = "hit";
+        if (b->policy == BOT_COWARD || (b->policy == BOT_EXPLORER && pl->health < pl->maxHealth * BOT_FLEE_HEALTH)) {
+            action = "flee";
+        } else if (b->policy == BOT_FIGHTER) {
+            action = "kick";
+        }
+        snprintf(command, size, "%s", action);
+        return;
+    }
+    if (!r->searched) {
+        snprintf(command, size, "look");
+        return;
+    }
+    if (r->item.type != ITEM_NONE && !r->item.looted && !player_check_inv_full(pl) && !player_check_has_same(pl)) {
+        snprintf(command, size, "pickup %s", names_get(r->item.name));
+        return;
+    }
+    if (b->policy == BOT_FIGHTER) {
+        for (int d = 0; d < 4; d++) {
+            if (r->mobs[d].type != ENEMY_NONE) {
+                snprintf(command, size, "attack %s", bot_directions[d]);
+                return;
+            }
+        }
+    }
+    int d = bot_choose_door(b, pl);
+    if (d == -1) {
+        snprintf(command, size, "look");
+        return;
+    }
+    if (r->mobs[d].type != ENEMY_NONE) {
+        snprintf(command, size, "attack %s", bot_directions[d]);
+        return;
+    }
+    b->moves++;
+    snprintf(command, size, "move %s", bot_directions[d]);
+}
+const char *bot_policy_name(BotPolicy policy) {
+    return (unsigned)policy < BOT_POLICY_COUNT ? bot_policy_names[policy] : "?";
+}
+/* @
+ * bot_policy_find: bool
+ * ----------------------
+ * Looks a policy up by its name (explorer, fighter or coward).
+ */
+bool bot_policy_find(const char *name, BotPolicy *policy) {
+    for (int i = 0; i < BOT_POLICY_COUNT; i++) {
+        if (strcasecmp(name, bot_policy_names[i]) == 0) {
+            *policy = (BotPolicy)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -10,72 +10,51 @@
  * - pl: Player* - Pointer to the Player structure.
  *
  * Notes:
- * - Executes attack logic for "hit" and "kick" with varying multipliers.
- * - Manages enemy and player damage calculations and checks for game-over conditions.
- * - Handles fleeing attempts with random success based on the enemy's flee chance.
+ * - The round itself is played by `player_war_round`, this only draws its outcome.
+ * - "hit" and "kick" deal damage with varying multipliers, a dead player gets the game-over screen.
+ * - Fleeing succeeds at random based on the enemy's flee chance.
  */
 void command_handle_war(const char *input, Player *pl)
 {
     move_cursor_output();
-    if (strcasecmp(input, "hit") == 0 || strcasecmp(input, "kick") == 0)
-    {
-        int multiplier = 1;
-        if (strcasecmp(input, "kick") == 0)
-            multiplier = 2;
-        float dmg = player_attack(pl, multiplier);
-        enemy_get_hit(&pl->room->mobs[pl->warIndex], dmg);
-        if (enemy_is_alive(&pl->room->mobs[pl->warIndex]))
-        {
-            // enemy still alive
-            float e_dmg = enemy_attack(&pl->room->mobs[pl->warIndex]);
-            player_get_hit(pl, e_dmg);
-            // check player still alive
-            if (player_check_alive(pl))
-            {
-                draw_output_text("You hit '%.1f' damage, the enemy hit you '%.1f' damage!", dmg, e_dmg);
-                draw_war_info(pl);
-                draw_player_stats(pl);
-            }
-            else
-            {
-                // GAME OVER
-                draw_game_over(pl);
-            }
-        }
-        else
-        {
-            memset(&pl->room->mobs[pl->warIndex], 0, sizeof(pl->room->mobs[pl->warIndex]));
-            pl->onWar = false;
-            pl->mobs_killed += 1;
-            change_info_to_room(pl->room);
-            draw_dungeon(pl->room);
-            draw_output_text("You hit '%.1f' and killed the enemy! Fight is over.", dmg);
-        }
-    }
+    WarAction action;
+    if (strcasecmp(input, "hit") == 0)
+        action = WAR_HIT;
+    else if (strcasecmp(input, "kick") == 0)
+        action = WAR_KICK;
     else if (strcasecmp(input, "flee") == 0)
-    {
-        srand(time(NULL));
-        int chance = rand() % 100 + 1;
-        if (chance <= pl->room->mobs[pl->warIndex].flee_chance * 100)
-        {
-            pl->onWar = false;
-            // delete that mob
-            memset(&pl->room->mobs[pl->warIndex], 0, sizeof(pl->room->mobs[pl->warIndex]));
-            draw_dungeon(pl->room);
-            draw_output_text("You succesfully run away from enemy!");
-        }
-        else
-        {
-            pl->room->mobs[pl->warIndex].flee_chance -= 0.1;
-            int e_dmg = enemy_attack(&pl->room->mobs[pl->warIndex]);
-            player_get_hit(pl, e_dmg);
-            draw_war_info(pl);
-            draw_output_text("You were unsuccessfull while trying to flee.");
-        }
-    }
+        action = WAR_FLEE;
     else
     {
         draw_output_text("Unknown fight command! Available commands are: hit, kick, flee");
+        return;
+    }
+
+    float dmg, e_dmg;
+    switch (player_war_round(pl, action, &dmg, &e_dmg))
+    {
+    case WAR_EXCHANGED:
+        draw_output_text("You hit '%.1f' damage, the enemy hit you '%.1f' damage!", dmg, e_dmg);
+        draw_war_info(pl);
+        draw_player_stats(pl);
+        break;
+    case WAR_PLAYER_DIED:
+        // GAME OVER
+        draw_game_over(pl);
+        break;
+    case WAR_ENEMY_KILLED:
+        change_info_to_room(pl->room);
+        draw_dungeon(pl->room);
+        draw_output_text("You hit '%.1f' and killed the enemy! Fight is over.", dmg);
+        break;
+    case WAR_FLED:
+        draw_dungeon(pl->room);
+        draw_output_text("You succesfully run away from enemy!");
+        break;
+    case WAR_FLEE_FAILED:
+        draw_war_info(pl);
+        draw_output_text("You were unsuccessfull while trying to flee.");
+        break;
     }
 }
 /* @
@@ -91,6 +70,7 @@ void command_handle_war(const char *input, Player *pl)
  * - Splits the input string into command and argument parts using space (" ") as a delimiter.
  * - Supports a wide range of commands, including:
  *   - "move" to navigate.
+ *   - "goto" to walk to a known room by its coordinates, or back to the start.
  *   - "look" to examine the surroundings.
  *   - "inventory" to view items.
  *   - "pickup" and "drop" for inventory management.
@@ -113,15 +93,17 @@ void command_handle(const char *input, Player *pl)
     memset(command, 0, sizeof(command));
 
     // Tokenize the input to extract the command and optional argument
+    // strtok_r: sessions on other threads (sim/bot_load.c) tokenize at the same time
     const char *delimiter = " ";
-    char *token = strtok((char *)input, delimiter);
+    char *rest = NULL;
+    char *token = strtok_r((char *)input, delimiter, &rest);
 
     if (token != 0)
     {
         strncpy(command, token, MAX_ARG_LENGTH);
         command[MAX_ARG_LENGTH - 1] = '\0'; // Ensure null-termination
 
-        token = strtok(0, ""); // Get the rest of the line as the argument
+        token = strtok_r(NULL, "", &rest); // Get the rest of the line as the argument
         if (token != 0)
         {
             strncpy(arg, token, MAX_ARG_LENGTH);
@@ -187,6 +169,22 @@ void command_handle(const char *input, Player *pl)
                 }
             }
         }
+        else if (strcasecmp(command, "goto") == 0)
+        {
+            int x, y;
+            if (strcasecmp(arg, "start") == 0)
+            {
+                player_goto(pl, 0, 0);
+            }
+            else if (sscanf(arg, "%d , %d", &x, &y) == 2)
+            {
+                player_goto(pl, x, y);
+            }
+            else
+            {
+                draw_output_text("You are at (%d, %d). Usage: goto <x,y | start>\n", (int)pl->x, (int)pl->y);
+            }
+        }
         else if (strcasecmp(command, "look") == 0)
         {
             change_info_title("> ROOM <");
@@ -204,7 +202,7 @@ void command_handle(const char *input, Player *pl)
                 memset(item_text, 0, sizeof(item_text));
                 if (pl->room->item.type != ITEM_NONE)
                 {
-                    sprintf(item_text, "Also you saw '%s' on the ground! Pick it up!", pl->room->item.name);
+                    sprintf(item_text, "Also you saw '%s' on the ground! Pick it up!", names_get(pl->room->item.name));
                     draw_item(&pl->room->item);
                 }
                 draw_output_text("You looked around and saw %d enemies! %s", enemyCount, item_text);
@@ -237,7 +235,7 @@ void command_handle(const char *input, Player *pl)
             }
             else
             {
-                if (strcasecmp(arg, pl->room->item.name) == 0 && pl->room->item.looted == false)
+                if (pl->room->item.type != ITEM_NONE && names_find(arg) == pl->room->item.name && pl->room->item.looted == false)
                 {
                     int result = player_get_item(pl);
                     if (result == 0)
@@ -245,7 +243,7 @@ void command_handle(const char *input, Player *pl)
                         clear_item_drawing();
                         change_info_to_room(pl->room);
                         clear_player_stats();
-                        draw_output_text("Picking up '%s'.\n", pl->room->item.name);
+                        draw_output_text("Picking up '%s'.\n", names_get(pl->room->item.name));
                         draw_player_stats(pl);
                     }
                     else if (result == 1)
@@ -254,7 +252,7 @@ void command_handle(const char *input, Player *pl)
                     }
                     else
                     {
-                        draw_output_text("You have same item named '%s'!", pl->room->item.name);
+                        draw_output_text("You have same item named '%s'!", names_get(pl->room->item.name));
                     }
                 }
                 else
@@ -304,7 +302,7 @@ void command_handle(const char *input, Player *pl)
         }
         else if (strcasecmp(command, "list") == 0)
         {
-            list_saves();
+            list_saves(arg);
         }
         else if (strcasecmp(command, "save") == 0)
         {
@@ -325,12 +323,11 @@ void command_handle(const char *input, Player *pl)
             }
             else
             {
-                Player *player = (Player *)malloc(sizeof(Player));
-                memset(player, 0, sizeof(*player));
-                load_player(player, arg);
-                draw_dungeon(player->room);
-                draw_player_stats(player);
-                *pl = *player;
+                if (load_player(pl, arg))
+                {
+                    draw_dungeon(pl->room);
+                    draw_player_stats(pl);
+                }
             }
         }
         else if (strcasecmp(command, "help") == 0)
@@ -341,6 +338,11 @@ void command_handle(const char *input, Player *pl)
         else if (strcasecmp(command, "exit") == 0)
         {
             draw_output_text("Game is closing... See you later!\n");
+            screen_flush();
+            // queued saves are finished first, a clean exit leaves no session to recover
+            save_shutdown();
+            journal_close(true);
+            world_close(pl->world, false);
             exit(0);
         }
         else
@@ -6,40 +6,41 @@
  *
  * Parameters:
  * - e: Enemy* - Pointer to the Enemy structure to be initialized.
+ * - rng: Rng* - Random state to roll with.
  *
  * Notes:
  * - Randomly determines the enemy type (SLIME, ZOMBIE, VAMPIRE, SKELETON).
  * - Assigns health, damage, critical hit properties, and flee chance for the selected type.
  */
-void enemy_create_random(Enemy *e)
+void enemy_create_random(Enemy *e, Rng *rng)
 {
     // set all fields to zero
     memset(e, 0, sizeof(*e));
 
-    unsigned char type = rand() % 4 + 1;
+    unsigned char type = rng_range(rng, 4) + 1;
     // Set basic properties
     switch (type)
     {
     case ENEMY_SLIME:
         e->type = ENEMY_SLIME;
-        e->health = 20 + rand() % 6;
-        e->damage = 8 + rand() % 3;
+        e->health = 20 + rng_range(rng, 6);
+        e->damage = 8 + rng_range(rng, 3);
         e->crit_rate = 1.1;
         e->crit_chance = 0.2;
         e->flee_chance = 0.8;
         break;
     case ENEMY_ZOMBIE:
         e->type = ENEMY_ZOMBIE;
-        e->health = 40 + rand() % 11;
-        e->damage = 5 + rand() % 5;
+        e->health = 40 + rng_range(rng, 11);
+        e->damage = 5 + rng_range(rng, 5);
         e->crit_rate = 1.5;
         e->crit_chance = 0.4;
         e->flee_chance = 0.70;
         break;
     case ENEMY_VAMPIRE:
         e->type = ENEMY_VAMPIRE;
-        e->health = 80 + rand() % 11;
-        e->damage = 8 + rand() % 5;
+        e->health = 80 + rng_range(rng, 11);
+        e->damage = 8 + rng_range(rng, 5);
         e->crit_rate = 1.25;
         e->crit_chance = 0.2;
         e->flee_chance = 0.60;
@@ -47,7 +48,7 @@ void enemy_create_random(Enemy *e)
     case ENEMY_SKELETON:
         e->type = ENEMY_SKELETON;
         e->health = 100;
-        e->damage = 15 + rand() % 5;
+        e->damage = 15 + rng_range(rng, 5);
         e->crit_rate = 1.34;
         e->crit_chance = 0.1;
         e->flee_chance = 0.45;
@@ -159,6 +160,7 @@ bool enemy_is_alive(Enemy *e) {
  *
  * Parameters:
  * - e: Enemy* - Pointer to the Enemy structure.
+ * - rng: Rng* - Random state to roll with.
  *
  * Returns:
  * - The amount of damage dealt as a float.
@@ -167,12 +169,11 @@ bool enemy_is_alive(Enemy *e) {
  * - A random chance determines whether the damage is a critical hit or normal.
  * - Critical hits multiply the damage by the crit_rate.
  */
-float enemy_attack(Enemy *e)
+float enemy_attack(Enemy *e, Rng *rng)
 {
     float damage = 0;
-    srand(time(0));
 
-    int chance = rand() % 100 + 1;
+    int chance = rng_range(rng, 100) + 1;
     if (chance <= e->crit_chance * 100)
     {
         // crit!
@@ -0,0 +1,176 @@
+#include "main.h"
+
+// Run seed from --seed. Without one, every game is seeded from the clock.
+static bool game_seeded = false;
+static uint64_t game_seed = 0;
+// --world procedural: rooms derived from (seed, x, y) instead of stored
+static bool game_procedural = false;
+
+/* @
+ * game_set_seed: void
+ * --------------------
+ * Makes every following game use counter-based random numbers keyed by seed,
+ * so the same seed always produces the same rooms, loot and fights.
+ *
+ * Parameters:
+ * - seed: uint64_t - Run seed.
+ */
+void game_set_seed(uint64_t seed)
+{
+    game_seeded = true;
+    game_seed = seed;
+}
+
+/* @
+ * game_set_procedural: void
+ * --------------------------
+ * Chooses how the following games build their world, see world_reset.
+ *
+ * Parameters:
+ * - procedural: bool - true for rooms derived from (seed, x, y).
+ */
+void game_set_procedural(bool procedural)
+{
+    game_procedural = procedural;
+}
+
+/* @
+ * game_start: void
+ * -----------------
+ * Sets up a new game, see init_game.
+ */
+static void game_start(Player *pl, bool seeded, uint64_t seed)
+{
+    // Room and item names are interned once per process
+    names_init();
+    // For better quality, get the terminal size from OS.
+    get_terminal_size();
+
+    // Create player, keeping the session's room pool, world map and distance fields
+    RoomPool *rooms = pl->rooms;
+    if (rooms == NULL) {
+        rooms = (RoomPool*)malloc(sizeof(RoomPool));
+    }
+    World *world = pl->world;
+    if (world == NULL) {
+        world = (World*)calloc(1, sizeof(World));
+    }
+    PathCache *paths = pl->paths;
+    if (paths == NULL) {
+        paths = path_cache_create();
+    }
+    room_pool_reset(rooms);
+    memset(pl, 0, sizeof(*pl));
+    pl->rooms = rooms;
+    pl->world = world;
+    pl->paths = paths;
+    player_start(pl);
+    if (seeded) {
+        rng_seed_counter(&pl->rng, seed);
+    } else {
+        rng_seed_from_time(&pl->rng, (uintptr_t)pl);
+    }
+    world_reset(pl->world, game_procedural, &pl->rng);
+    // Create first room at (0, 0)
+    Room *r = room_pool_acquire(pl->rooms);
+    pl->room_index = world_enter(pl->world, 0, 0, &pl->rng, r, 0);
+    pl->room = r;
+    // Draw borders, title, input text, room and stats
+    draw_game(pl);
+}
+
+/* @
+ * init_game: void
+ * ---------------
+ * Initializes the game by setting up the terminal, drawing the screen layout,
+ * and creating the initial room and player state.
+ *
+ * Parameters:
+ * - pl: Player* - Pointer to the Player structure to be initialized. It must be
+ *   zeroed before the first call; later calls (restarts) reuse its room pool.
+ *
+ * Notes:
+ * - Builds the name table and calls helper functions to get the terminal size
+ *   and draw game borders.
+ * - Seeds the session's random state (from --seed if given, else from the clock),
+ *   sets up the player's initial stats and creates the first room (room index 0).
+ * - Displays the dungeon and player stats on the screen.
+ */
+void init_game(Player *pl){
+    game_start(pl, game_seeded, game_seed);
+}
+
+/* @
+ * init_game_seeded: void
+ * -----------------------
+ * Starts a game like init_game, but keyed by its own seed instead of --seed,
+ * for a process that plays many games at once (sim/bot_load.c).
+ *
+ * Parameters:
+ * - pl: Player* - Pointer to the Player structure, as for init_game.
+ * - seed: uint64_t - Seed of this game's counter-based random numbers.
+ */
+void init_game_seeded(Player *pl, uint64_t seed)
+{
+    game_start(pl, true, seed);
+}
+
+/* @
+ * game_run_script: int
+ * ---------------------
+ * Plays a command file through command_handle as fast as it can be read,
+ * like the main loop would with a player typing it, then reports the
+ * throughput on stderr. With --seed the same script always plays the same
+ * game and draws the same screens.
+ *
+ * Parameters:
+ * - pl: Player* - Freshly initialized game.
+ * - script: FILE* - One command per line; lines starting with '#' are skipped.
+ *   The script ends at its end or at an `exit` line.
+ *
+ * Returns:
+ * - 0 when the script was played to its end, -1 if it could not be read.
+ *
+ * Notes:
+ * - Saves are finished before the next command runs, so their messages always
+ *   show up at the same point.
+ * - The session is not journaled: a script is its own journal.
+ */
+int game_run_script(Player *pl, FILE *script)
+{
+    char input[128];
+    int commands = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    move_cursor_default();
+    screen_flush();
+    while (fgets(input, sizeof(input), script) != NULL)
+    {
+        input[strcspn(input, "\r\n")] = '\0';
+        if (input[0] == '#')
+        {
+            continue;
+        }
+        if (strcasecmp(input, "exit") == 0)
+        {
+            break;
+        }
+        clear_input();
+        move_cursor_default();
+        command_handle(input, pl);
+        commands++;
+        save_shutdown();
+        save_take_done();
+        move_cursor_default();
+        screen_flush();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    bool failed = ferror(script) != 0;
+    save_shutdown();
+    world_close(pl->world, false);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    fprintf(stderr, "%s: %d commands in %.3f s (%.0f commands/s)\n", failed ? "Script read error" : "Script done",
+            commands, elapsed, elapsed > 0 ? commands / elapsed : 0);
+    return failed ? -1 : 0;
+}
\ No newline at end of file
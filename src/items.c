@@ -1,7 +1,5 @@
 #include "items.h"
 
-char *NameList_1[] = { "Cebeci's", "Reptile", "God's", "AYBU's", "Rat", "Bear", "Big" };
-char *NameList_2[] = { "Bracelet", "Necklace", "Bone", "Golden Ring" };
 /* @
  * item_create_random: void
  * -------------------------
@@ -9,85 +7,48 @@ char *NameList_2[] = { "Bracelet", "Necklace", "Bone", "Golden Ring" };
  *
  * Parameters:
  * - i: Item* - Pointer to the Item structure to be initialized.
+ * - rng: Rng* - Random state to roll with.
  *
  * Notes:
  * - Randomly determines the item type (SWORD, SHIELD, ELIXIR, GENERAL, NONE).
  * - For ITEM_SWORD and ITEM_SHIELD, properties such as strength or defence are assigned.
  * - ITEM_ELIXIR can either be a "Small Elixir" (25 health) or a "Big Elixir" (50 health).
- * - Names are randomly generated using the `item_get_random_name` function.
+ * - Names are picked from the interned name table (see names.c), so an item
+ *   only stores a NameId.
  */
 
-void item_create_random(Item *i){
-    int type  = rand() % 5;
+void item_create_random(Item *i, Rng *rng){
+    int type  = rng_range(rng, 5);
     // Set basic properties
     switch(type) {
         case ITEM_SWORD:
             i->type = ITEM_SWORD;
-            i->name = item_get_random_name(NameList_1, " Sword");
-            i->strength = 3 + rand() % 11;
-            i->crit_rate = 0.05 + ((rand() % 11 + 0.5) / 100);
+            i->name = names_random(NAMES_SWORD, rng);
+            i->strength = 3 + rng_range(rng, 11);
+            i->crit_rate = 0.05 + ((rng_range(rng, 11) + 0.5) / 100);
             break;
         case ITEM_SHIELD:
             i->type = ITEM_SHIELD;
-            i->name = item_get_random_name(NameList_1, " Shield");
-            i->defence = 3 + rand() % 11; 
+            i->name = names_random(NAMES_SHIELD, rng);
+            i->defence = 3 + rng_range(rng, 11); 
             break;
         case ITEM_ELIXIR:
             i->type = ITEM_ELIXIR;
-            int elixir_type  = (rand() % 2);
+            int elixir_type  = rng_range(rng, 2);
             if (elixir_type) {
                 i->health = 50;
-                i->name = "Big Elixir";
+                i->name = names_in_group(NAMES_ELIXIR, 1);
             } else {
                 i->health = 25;
-                i->name = "Small Elixir";
+                i->name = names_in_group(NAMES_ELIXIR, 0);
             }
             break;
         case ITEM_GENERAL:
             i->type = ITEM_GENERAL;
-            i->name = item_get_random_name(NameList_2, "");
+            i->name = names_random(NAMES_GENERAL, rng);
             break;
         case ITEM_NONE:
             i->type = ITEM_NONE;
             break;
     }
-}
-/* @
- * item_get_random_name: char*
- * ----------------------------
- * Generates a random name for an item by combining a random prefix from a list
- * and a specified suffix.
- *
- * Parameters:
- * - list: char*[] - Array of string pointers to be used as prefixes.
- * - last: char* - The suffix to append to the randomly chosen prefix.
- *
- * Returns:
- * - A dynamically allocated string containing the combined item name.
- * - Returns NULL if memory allocation fails.
- *
- * Notes:
- * - Ensures random selection of a string from the given list using `rand()`.
- */
-char *item_get_random_name(char* list[], char* last) {
-    int list_size = 0;
-    while (list[list_size] != NULL) {
-        list_size++;
-    }
-
-    int random_index = rand() % list_size;
-
-    char* selected_string = list[random_index];
-
-    size_t result_length = strlen(selected_string) + strlen(last) + 1;
-    char* result = (char*)malloc(result_length * sizeof(char));
-
-    if (!result) {
-        return NULL;
-    }
-    
-    strcpy(result, selected_string);
-    strcat(result, last);
-
-    return result;
 }
\ No newline at end of file
@@ -0,0 +1,442 @@
+#include "journal.h"
+
+// Session journal, so a game survives a crash or a dropped connection
+// without the player typing `save`.
+//   session_<name>.snap: magic "AYBS" | u32 seq | encoded save (see save_encode), whose
+//                        spilled chunks are records of session_<name>.chunks
+//   session_<name>.jnl : magic "AYBJ" | records
+//   record             : u32 seq | u64 game state fingerprint | u8 length | command | u32 CRC32
+// Every number is little-endian. seq counts journaled commands, so records
+// already covered by the snapshot are skipped even if the journal was not
+// truncated after it.
+#define JOURNAL_MAGIC "AYBJ"
+#define SNAPSHOT_MAGIC "AYBS"
+#define JOURNAL_RECORD_MAX (4 + 8 + 1 + 255 + 4)
+
+static FILE *journal_file = NULL;
+static char journal_path[80];
+static char snapshot_path[80];
+// Records not handed to the OS yet
+static unsigned char journal_buffer[JOURNAL_BUFFER_SIZE];
+static size_t journal_buffered = 0;
+static int journal_batched = 0;
+
+static uint32_t journal_seq = 0;
+static int journal_since_snapshot = 0;
+static bool journal_recorded = false;
+static bool journal_force_snapshot = false;
+// journal_open was called: commands are recorded even while journal_file is
+// missing, the next snapshot that works starts it
+static bool journal_active = false;
+// errno of the last snapshot that failed, 0 once one works again
+static int journal_error = 0;
+static bool journal_reported = false;
+// Map of the snapshot on disk: the chunk file records it refers to are kept
+// as they are until the next snapshot
+static WorldImage journal_image;
+// End of the last intact record journal_replay read, where a recovered
+// session goes on appending if it can't take a snapshot
+static long journal_intact = 0;
+
+// Set from the SIGHUP/SIGTERM handler, consumed by journal_take_hangup.
+static volatile sig_atomic_t hangup_pending = 0;
+
+// Commands that don't change the game (or must not run twice) are not journaled
+static const char *journal_skips[] = { "exit", "save", "list", "help", "inventory", NULL };
+
+static void put_le(unsigned char *p, uint64_t value, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const unsigned char *p, int n) {
+    uint64_t value = 0;
+    for (int i = 0; i < n; i++) {
+        value |= (uint64_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+/* @
+ * journal_fingerprint: uint64_t
+ * ------------------------------
+ * Summarizes the random states, progress, position and world map of a
+ * player. Replay compares it with the recorded one before every command and
+ * stops where they differ.
+ */
+static uint64_t journal_fingerprint(Player *pl) {
+    uint64_t session = pl->rng.state ^ pl->rng.inc ^ pl->rng.counter ^ pl->rng.key;
+    uint64_t fight = pl->war_rng.state ^ pl->war_rng.counter ^ pl->war_rng.stream;
+    uint64_t place = ((uint64_t)(uint32_t)pl->x << 32 | (uint32_t)pl->y) ^ pl->room_index;
+    uint64_t map = ((uint64_t)pl->world->count << 32 | pl->world->next_index) ^ (uint64_t)pl->world->frontier << 20;
+    return session ^ fight * 0x9E3779B97F4A7C15ull ^ (uint64_t)(uint32_t)pl->rooms_walked << 40
+        ^ place * 0xBF58476D1CE4E5B9ull ^ map * 0x94D049BB133111EBull;
+}
+
+/* @
+ * journal_keep: void
+ * -------------------
+ * Makes image the map of the snapshot on disk, releasing the previous one.
+ */
+static void journal_keep(WorldImage *image) {
+    world_image_free(&journal_image);
+    journal_image = *image;
+    // only the records it holds matter, not its copies of the chunks in memory
+    free(journal_image.rooms);
+    journal_image.rooms = NULL;
+    journal_image.count = 0;
+}
+
+/* @
+ * journal_snapshot: bool
+ * -----------------------
+ * Writes the game state to the snapshot file (through a temporary file and a
+ * rename, so a crash never leaves half a snapshot), then starts an empty
+ * journal. Only the chunks of the map in memory are written, spilled chunks
+ * are referred to by their records in the chunk file, so a snapshot costs the
+ * same however large the map grows.
+ *
+ * Parameters:
+ * - pl: Player* - Current game state.
+ *
+ * Returns:
+ * - false if the snapshot or the new journal could not be written, the
+ *   previous snapshot and journal are then still in place (journal_error tells why).
+ */
+static bool journal_snapshot(Player *pl) {
+    WorldImage world;
+    if (!world_export(pl->world, &world)) {
+        journal_error = ENOMEM;
+        return false;
+    }
+    world.references = true;
+
+    char temp_path[sizeof(snapshot_path) + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", snapshot_path);
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        journal_error = errno;
+        world_image_free(&world);
+        return false;
+    }
+    unsigned char head[8];
+    memcpy(head, SNAPSHOT_MAGIC, 4);
+    put_le(head + 4, journal_seq, 4);
+    bool ok = fwrite(head, 1, sizeof(head), file) == sizeof(head) && save_encode_file(pl, &world, file) > 0;
+    int error = errno;
+    ok = fclose(file) == 0 && ok;
+#ifdef _WIN32
+    // rename doesn't replace existing files on Windows
+    if (ok) {
+        remove(snapshot_path);
+    }
+#endif
+    if (!ok || rename(temp_path, snapshot_path) != 0) {
+        journal_error = !ok ? error : errno;
+        if (journal_error == 0) {
+            journal_error = EIO;
+        }
+        remove(temp_path);
+        world_image_free(&world);
+        return false;
+    }
+    journal_keep(&world);
+
+    // everything journaled so far is in the snapshot now
+    journal_buffered = 0;
+    journal_batched = 0;
+    journal_since_snapshot = 0;
+    if (journal_file != NULL) {
+        fclose(journal_file);
+    }
+    journal_file = fopen(journal_path, "wb");
+    if (journal_file == NULL) {
+        journal_error = errno;
+        return false;
+    }
+    fwrite(JOURNAL_MAGIC, 1, 4, journal_file);
+    fflush(journal_file);
+    journal_error = 0;
+    journal_reported = false;
+    return true;
+}
+
+/* @
+ * journal_report: void
+ * ---------------------
+ * Tells the player, once, that the last snapshot failed and recent commands
+ * may not survive a crash. Nothing happens while snapshots work.
+ */
+void journal_report() {
+    if (journal_error != 0 && !journal_reported) {
+        draw_output_text("The session journal can not be written (%s), a crash may lose recent commands!", strerror(journal_error));
+        journal_reported = true;
+    }
+}
+
+/* @
+ * journal_replay: int
+ * --------------------
+ * Restores the session from its snapshot and replays the journal tail on it.
+ * Nothing is drawn while replaying.
+ *
+ * Parameters:
+ * - pl: Player* - Game state to replace.
+ *
+ * Returns:
+ * - Number of replayed commands, or -1 if there was no valid snapshot.
+ */
+static int journal_replay(Player *pl) {
+    size_t size = 0;
+    unsigned char *snapshot = save_read_file(snapshot_path, &size);
+    if (snapshot == NULL) {
+        return -1;
+    }
+    bool restored = size >= 8 && memcmp(snapshot, SNAPSHOT_MAGIC, 4) == 0
+        && save_restore(pl, snapshot + 8, size - 8);
+    if (restored) {
+        journal_seq = (uint32_t)get_le(snapshot + 4, 4);
+    }
+    free(snapshot);
+    if (!restored) {
+        return -1;
+    }
+    // the replayed commands must not overwrite the chunks the snapshot refers
+    // to, it stays the one on disk until the next snapshot works
+    WorldImage image;
+    if (!world_export(pl->world, &image)) {
+        return 0;
+    }
+    journal_keep(&image);
+
+    FILE *file = fopen(journal_path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    int replayed = 0;
+    unsigned char magic[4];
+    if (fread(magic, 1, 4, file) == 4 && memcmp(magic, JOURNAL_MAGIC, 4) == 0) {
+        journal_intact = 4;
+        const RenderBackend *shown = screen_get_backend();
+        screen_set_backend(render_backend_find("null"));
+        unsigned char record[JOURNAL_RECORD_MAX];
+        // stop at the first torn, corrupted, out of order or diverging record
+        while (fread(record, 1, 13, file) == 13) {
+            size_t length = record[12];
+            if (fread(record + 13, 1, length + 4, file) != length + 4
+                || get_le(record + 13 + length, 4) != save_crc32(record, 13 + length)) {
+                break;
+            }
+            uint32_t seq = (uint32_t)get_le(record, 4);
+            if (seq <= journal_seq) {
+                journal_intact = ftell(file);
+                continue;
+            }
+            if (seq != journal_seq + 1 || get_le(record + 4, 8) != journal_fingerprint(pl)) {
+                break;
+            }
+            char input[256];
+            memcpy(input, record + 13, length);
+            input[length] = '\0';
+            command_handle(input, pl);
+            journal_seq = seq;
+            journal_intact = ftell(file);
+            replayed++;
+        }
+        screen_set_backend(shown);
+    }
+    fclose(file);
+    return replayed;
+}
+
+/* @
+ * journal_open: int
+ * ------------------
+ * Starts journaling a session. If the session was not closed cleanly last
+ * time, it is rebuilt from its latest snapshot plus the journal tail first.
+ *
+ * Parameters:
+ * - session: const char* - Session name, used for the file names.
+ * - pl: Player* - Freshly initialized game, replaced when a session is recovered.
+ *
+ * Returns:
+ * - Number of replayed commands if a session was recovered, -1 otherwise.
+ *
+ * Notes:
+ * - The caller repaints the game after a recovery, then calls journal_report.
+ */
+int journal_open(const char *session, Player *pl) {
+    snprintf(journal_path, sizeof(journal_path), "session_%s.jnl", session);
+    snprintf(snapshot_path, sizeof(snapshot_path), "session_%s.snap", session);
+    journal_seq = 0;
+    journal_intact = 0;
+    journal_active = true;
+    int replayed = journal_replay(pl);
+    // compact right away: the recovered (or new) game becomes the snapshot;
+    // if that fails it is retried after JOURNAL_SNAPSHOT_EVERY commands and
+    // the caller shows why with journal_report
+    if (!journal_snapshot(pl) && replayed >= 0) {
+        // the old snapshot still stands, keep journaling after its records
+        // (whatever follows them fails the CRC or sequence check on replay)
+        if (journal_intact >= 4) {
+            journal_file = fopen(journal_path, "r+b");
+            if (journal_file != NULL && fseek(journal_file, journal_intact, SEEK_SET) != 0) {
+                fclose(journal_file);
+                journal_file = NULL;
+            }
+        } else {
+            journal_file = fopen(journal_path, "wb");
+            if (journal_file != NULL) {
+                fwrite(JOURNAL_MAGIC, 1, 4, journal_file);
+                fflush(journal_file);
+            }
+        }
+    }
+    return replayed;
+}
+
+/* @
+ * journal_record: void
+ * ---------------------
+ * Appends a command to the journal buffer. Call it before command_handle,
+ * which tokenizes the input in place.
+ *
+ * Parameters:
+ * - input: const char* - The command line as typed.
+ * - pl: Player* - Game state the command is about to run on.
+ */
+void journal_record(const char *input, Player *pl) {
+    journal_recorded = false;
+    size_t length = strlen(input);
+    size_t word = strcspn(input, " ");
+    if (!journal_active || word == 0 || length > 255) {
+        return;
+    }
+    for (int i = 0; journal_skips[i] != NULL; i++) {
+        if (strlen(journal_skips[i]) == word && strncasecmp(input, journal_skips[i], word) == 0) {
+            return;
+        }
+    }
+    // a restart reseeds from the clock and a load reads a file, neither
+    // replays the same way, so the state after them goes to a snapshot
+    if (pl->health <= 0 || (word == 4 && strncasecmp(input, "load", 4) == 0)) {
+        journal_force_snapshot = true;
+    }
+
+    if (journal_buffered + JOURNAL_RECORD_MAX > sizeof(journal_buffer)) {
+        journal_flush();
+    }
+    unsigned char *record = journal_buffer + journal_buffered;
+    journal_seq++;
+    put_le(record, journal_seq, 4);
+    put_le(record + 4, journal_fingerprint(pl), 8);
+    record[12] = (unsigned char)length;
+    memcpy(record + 13, input, length);
+    put_le(record + 13 + length, save_crc32(record, 13 + length), 4);
+    journal_buffered += 13 + length + 4;
+    journal_recorded = true;
+}
+
+/* @
+ * journal_commit: void
+ * ---------------------
+ * Called after command_handle. Takes a snapshot every JOURNAL_SNAPSHOT_EVERY
+ * commands and hands buffered records to the OS every JOURNAL_BATCH commands.
+ *
+ * Parameters:
+ * - pl: Player* - Game state after the command.
+ */
+void journal_commit(Player *pl) {
+    if (!journal_recorded) {
+        return;
+    }
+    journal_recorded = false;
+    journal_since_snapshot++;
+    journal_batched++;
+    if (journal_force_snapshot || journal_since_snapshot >= JOURNAL_SNAPSHOT_EVERY) {
+        journal_force_snapshot = false;
+        if (!journal_snapshot(pl)) {
+            // the journal since the last snapshot still holds everything, keep
+            // handing it to the OS and try again after as many commands
+            journal_flush();
+            journal_since_snapshot = 0;
+            journal_report();
+        }
+    } else if (journal_batched >= JOURNAL_BATCH) {
+        journal_flush();
+    }
+}
+
+/* @
+ * journal_flush: void
+ * --------------------
+ * Writes buffered records to the journal file. There is no fsync: the game
+ * never waits for the disk, only for the OS to take the bytes.
+ */
+void journal_flush() {
+    if (journal_file != NULL && journal_buffered > 0) {
+        fwrite(journal_buffer, 1, journal_buffered, journal_file);
+        fflush(journal_file);
+    }
+    journal_buffered = 0;
+    journal_batched = 0;
+}
+
+/* @
+ * journal_close: void
+ * --------------------
+ * Stops journaling.
+ *
+ * Parameters:
+ * - clean: bool - true when the player exits the game, the session files are
+ *   removed. false keeps them (after flushing) so the next start recovers.
+ */
+void journal_close(bool clean) {
+    if (!journal_active) {
+        return;
+    }
+    journal_active = false;
+    journal_flush();
+    if (journal_file != NULL) {
+        fclose(journal_file);
+        journal_file = NULL;
+    }
+    world_image_free(&journal_image);
+    if (clean) {
+        remove(journal_path);
+        remove(snapshot_path);
+    }
+}
+
+static void handle_hangup(int sig) {
+    (void)sig;
+    hangup_pending = 1;
+}
+
+/* @
+ * journal_watch_hangup: void
+ * ---------------------------
+ * Installs SIGHUP/SIGTERM handlers without SA_RESTART, so a dropped terminal
+ * or a kill wakes up the read of the next command and the journal is flushed
+ * before the game quits.
+ */
+void journal_watch_hangup() {
+#ifdef SIGHUP
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_hangup;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGHUP, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+#endif
+}
+
+/* @
+ * journal_take_hangup: bool
+ * --------------------------
+ * Returns true once a SIGHUP or SIGTERM arrived.
+ */
+bool journal_take_hangup() {
+    return hangup_pending != 0;
+}
@@ -1,63 +1,109 @@
 #include "main.h"
 
-/* @
- * init_game: void
- * ---------------
- * Initializes the game by setting up the terminal, drawing the screen layout,
- * and creating the initial room and player state.
- *
- * Parameters:
- * - pl: Player* - Pointer to the Player structure to be initialized.
- *
- * Notes:
- * - Calls helper functions to get the terminal size and draw game borders.
- * - Creates the first room randomly and sets up the player's initial stats.
- * - Displays the dungeon and player stats on the screen.
- */
-void init_game(Player *pl){
-    // For better quality, get the terminal size from OS.
-    get_terminal_size();
-
-    // Drawing borders of game screen
-    draw_borders();
-
-    // Draw title
-    draw_text_center("> Dungeons of AYBU <", 0);
-    
-    // Draw input text
-    draw_input_text();
-
-    // Create first room
-    Room *r = (Room*)malloc(sizeof(Room));
-    room_create_random(r, 0);
-    // Create player
-    memset(pl, 0, sizeof(*pl));
-    player_start(pl);
-    pl->room = r;
-    draw_dungeon(r);
-    draw_player_stats(pl);
-}
 /* @
  * main: int
  * ---------
  * The entry point for the game. Initializes the game and enters the command handling loop.
  *
+ * Parameters:
+ * - argc, argv: Command line. `--render <ansi|null|recording>` picks the render backend
+ *   (default: ansi, the terminal). `null` runs the game without any output.
+ *   `--seed <number>` makes the game reproducible: the same seed gives the same rooms and fights.
+ *   `--session <name>` names the session journal (default: "default").
+ *   `--world <stored|procedural>` picks how rooms are made (default: stored).
+ *   `--script <file>` plays a command file (`-` for stdin) without waiting for
+ *   input and reports commands/sec, see game_run_script.
+ *
  * Returns:
- * - 0 on successful execution, -1 on error during input.
+ * - 0 on successful execution, -1 on error during input or bad arguments.
  *
  * Notes:
  * - Allocates memory for the player and initializes the game state.
  * - Enters a loop to read user input, process commands, and update the game state.
+ * - The screen is flushed once per loop, right before waiting for the next command.
  * - Commands are handled by `command_handle` function, with input sanitized to remove newline characters.
+ * - A terminal resize interrupts the wait for input; the layout is rebuilt and the game repainted once.
+ * - Saves are written by a background thread; their result is shown as soon as they finish.
+ * - Every command is journaled; a session that ended without `exit` is recovered on the next start.
+ * - Cold chunks of the world map are spilled to session_<name>.chunks, removed on any exit.
  */
-int main() {
-    Player *pl = (Player*)malloc(sizeof(Player));
+int main(int argc, char *argv[]) {
+    const char *session = "default";
+    const char *script = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--render") == 0 && i + 1 < argc) {
+            const RenderBackend *backend = render_backend_find(argv[++i]);
+            if (backend == NULL) {
+                fprintf(stderr, "Unknown render backend '%s'. Use ansi, null or recording.\n", argv[i]);
+                return -1;
+            }
+            screen_set_backend(backend);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            game_set_seed(strtoull(argv[++i], NULL, 0));
+        } else if (strcmp(argv[i], "--session") == 0 && i + 1 < argc) {
+            session = argv[++i];
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script = argv[++i];
+        } else if (strcmp(argv[i], "--world") == 0 && i + 1 < argc
+                   && (strcmp(argv[i + 1], "stored") == 0 || strcmp(argv[i + 1], "procedural") == 0)) {
+            game_set_procedural(strcmp(argv[++i], "procedural") == 0);
+        } else {
+            fprintf(stderr, "Usage: %s [--render <ansi|null|recording>] [--seed <number>] [--session <name>] [--world <stored|procedural>] [--script <file|->]\n", argv[0]);
+            return -1;
+        }
+    }
+    FILE *script_file = NULL;
+    if (script != NULL) {
+        script_file = strcmp(script, "-") == 0 ? stdin : fopen(script, "r");
+        if (script_file == NULL) {
+            fprintf(stderr, "Can not open script '%s': %s\n", script, strerror(errno));
+            return -1;
+        }
+    }
+    world_set_session(session);
+    Player *pl = (Player*)calloc(1, sizeof(Player));
     init_game(pl);
+    if (script_file != NULL) {
+        return game_run_script(pl, script_file);
+    }
+    int replayed = journal_open(session, pl);
+    if (replayed >= 0) {
+        get_terminal_size();
+        draw_game(pl);
+        draw_output_text("Session '%s' recovered (%d commands replayed).", session, replayed);
+    }
+    // a session that can't be journaled still plays, but the player is told
+    journal_report();
+    screen_watch_resize();
+    journal_watch_hangup();
     // COMMAND HANDLING
     char input[128];
     while(1) {
+        if (journal_take_hangup()) {
+            save_shutdown();
+            journal_close(false);
+            // the session's snapshot refers to the chunk file
+            world_close(pl->world, true);
+            return -1;
+        }
+        if (screen_take_resize()) {
+            draw_game(pl);
+        }
+        // saves finished by the writer thread since the last command
+        save_take_done();
         move_cursor_default();
+        // Send everything this command changed on screen in one go
+        screen_flush();
         if (fgets(input, sizeof(input), stdin) == NULL) {
+            if (ferror(stdin) && errno == EINTR) {
+                // interrupted by a resize or a finished save, nothing was read yet
+                clearerr(stdin);
+                continue;
+            }
+            save_shutdown();
+            journal_close(false);
+            // the session's snapshot refers to the chunk file
+            world_close(pl->world, true);
             printf("Error reading input. Exiting.\n");
             return -1;
         }
@@ -66,7 +112,10 @@ int main() {
 
         clear_input();
         move_cursor_default();
+        // recorded before command_handle, which tokenizes input in place
+        journal_record(input, pl);
         command_handle(input, pl);
+        journal_commit(pl);
 
     }
     return 0;
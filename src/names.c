@@ -0,0 +1,114 @@
+#include "names.h"
+
+char *Room_Names[] = { "Dungeon", "Big", "Small", "Medium", "Haunted", "Rocky", "Cold" };
+char *NameList_1[] = { "Cebeci's", "Reptile", "God's", "AYBU's", "Rat", "Bear", "Big" };
+char *NameList_2[] = { "Bracelet", "Necklace", "Bone", "Golden Ring" };
+// Index 1 is the big one, see item_create_random
+char *Elixir_Names[] = { "Small Elixir", "Big Elixir" };
+
+// Every possible room and item name, built once by names_init
+static char name_pool[NAMES_MAX][NAME_LENGTH];
+static int name_count = 0;
+static int group_first[NAMES_GROUP_COUNT];
+static int group_size[NAMES_GROUP_COUNT];
+
+/* @
+ * names_add_group: void
+ * ----------------------
+ * Interns every name of a group: each prefix from the list plus the suffix.
+ *
+ * Parameters:
+ * - group: NameGroup - Group being built.
+ * - list: char*[] - Name prefixes.
+ * - count: int - Number of entries in list.
+ * - last: char* - Suffix appended to every prefix.
+ */
+static void names_add_group(NameGroup group, char *list[], int count, char *last)
+{
+    group_first[group] = name_count;
+    group_size[group] = count;
+    for (int i = 0; i < count && name_count < NAMES_MAX; i++)
+    {
+        snprintf(name_pool[name_count++], NAME_LENGTH, "%s%s", list[i], last);
+    }
+}
+/* @
+ * names_init: void
+ * -----------------
+ * Builds the interned name table. Call it once at startup, before any room
+ * or item is created; later calls do nothing.
+ */
+void names_init()
+{
+    if (name_count > 0)
+    {
+        return;
+    }
+    name_pool[0][0] = '\0'; // NAME_NONE
+    name_count = 1;
+    names_add_group(NAMES_ROOM, Room_Names, sizeof(Room_Names) / sizeof(Room_Names[0]), " Room");
+    names_add_group(NAMES_SWORD, NameList_1, sizeof(NameList_1) / sizeof(NameList_1[0]), " Sword");
+    names_add_group(NAMES_SHIELD, NameList_1, sizeof(NameList_1) / sizeof(NameList_1[0]), " Shield");
+    names_add_group(NAMES_ELIXIR, Elixir_Names, sizeof(Elixir_Names) / sizeof(Elixir_Names[0]), "");
+    names_add_group(NAMES_GENERAL, NameList_2, sizeof(NameList_2) / sizeof(NameList_2[0]), "");
+}
+/* @
+ * names_get: const char*
+ * -----------------------
+ * Returns the text of an interned name.
+ *
+ * Parameters:
+ * - id: NameId - Name id, NAME_NONE gives an empty string.
+ */
+const char *names_get(NameId id)
+{
+    if (id >= name_count)
+    {
+        return "";
+    }
+    return name_pool[id];
+}
+/* @
+ * names_find: NameId
+ * -------------------
+ * Looks up the id of a name typed by the player (case-insensitive).
+ *
+ * Parameters:
+ * - name: const char* - Name to look for.
+ *
+ * Returns:
+ * - The name's id, or NAME_NONE if no room or item has that name.
+ */
+NameId names_find(const char *name)
+{
+    for (int i = 1; i < name_count; i++)
+    {
+        if (strcasecmp(name_pool[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return NAME_NONE;
+}
+/* @
+ * names_in_group: NameId
+ * -----------------------
+ * Returns the id of the index-th name of a group.
+ */
+NameId names_in_group(NameGroup group, int index)
+{
+    return group_first[group] + index;
+}
+/* @
+ * names_random: NameId
+ * ---------------------
+ * Picks a random name of a group.
+ *
+ * Parameters:
+ * - group: NameGroup - Group to pick from.
+ * - rng: Rng* - Random state to pick with.
+ */
+NameId names_random(NameGroup group, Rng *rng)
+{
+    return group_first[group] + rng_range(rng, group_size[group]);
+}
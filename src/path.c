@@ -0,0 +1,236 @@
+#include "path.h"
+
+/* @
+ * path_hash: uint32_t
+ * --------------------
+ * Hash of a room coordinate for the distance tables.
+ */
+static uint32_t path_hash(int32_t x, int32_t y) {
+    uint64_t h = ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+/* @
+ * path_cache_create: PathCache*
+ * ------------------------------
+ * Allocates an empty cache of distance fields, one per session.
+ *
+ * Returns:
+ * - The cache, or NULL if out of memory.
+ */
+PathCache *path_cache_create() {
+    return (PathCache*)calloc(1, sizeof(PathCache));
+}
+/* @
+ * path_slot: PathNode*
+ * ---------------------
+ * Finds the node of a room in a field, or the empty slot where it goes.
+ */
+static PathNode *path_slot(PathField *f, int32_t x, int32_t y) {
+    uint32_t i = path_hash(x, y) & (f->capacity - 1);
+    while (f->nodes[i].dist != 0 && (f->nodes[i].x != x || f->nodes[i].y != y)) {
+        i = (i + 1) & (f->capacity - 1);
+    }
+    return &f->nodes[i];
+}
+static PathNode *path_find(PathField *f, int32_t x, int32_t y) {
+    if (f->capacity == 0) {
+        return NULL;
+    }
+    PathNode *n = path_slot(f, x, y);
+    return n->dist != 0 ? n : NULL;
+}
+/* @
+ * path_label: bool
+ * -----------------
+ * Gives a room its distance and queues it to be searched from, growing the
+ * node table (kept at most half full) and the queue as needed.
+ *
+ * Returns:
+ * - false if the field is full (PATH_MAX_ROOMS) or out of memory.
+ */
+static bool path_label(PathField *f, int32_t x, int32_t y, uint32_t dist) {
+    if (f->count >= PATH_MAX_ROOMS) {
+        return false;
+    }
+    if ((f->count + 1) * 2 > f->capacity) {
+        uint32_t capacity = f->capacity == 0 ? 1024 : f->capacity * 2;
+        PathNode *grown = (PathNode*)calloc(capacity, sizeof(PathNode));
+        if (grown == NULL) {
+            return false;
+        }
+        PathNode *old = f->nodes;
+        uint32_t old_capacity = f->capacity;
+        f->nodes = grown;
+        f->capacity = capacity;
+        for (uint32_t i = 0; i < old_capacity; i++) {
+            if (old[i].dist != 0) {
+                *path_slot(f, old[i].x, old[i].y) = old[i];
+            }
+        }
+        free(old);
+    }
+    if (f->tail == f->queue_capacity) {
+        uint32_t capacity = f->queue_capacity == 0 ? 1024 : f->queue_capacity * 2;
+        PathPoint *grown = (PathPoint*)realloc(f->queue, capacity * sizeof(PathPoint));
+        if (grown == NULL) {
+            return false;
+        }
+        f->queue = grown;
+        f->queue_capacity = capacity;
+    }
+    PathNode *n = path_slot(f, x, y);
+    n->x = x;
+    n->y = y;
+    n->dist = dist;
+    f->count++;
+    f->queue[f->tail].x = x;
+    f->queue[f->tail].y = y;
+    f->tail++;
+    return true;
+}
+/* @
+ * path_start: void
+ * -----------------
+ * (Re)starts a field from its target, for the map as it is now.
+ */
+static void path_start(PathField *f, World *w, int32_t tx, int32_t ty) {
+    if (f->nodes != NULL) {
+        memset(f->nodes, 0, f->capacity * sizeof(PathNode));
+    }
+    f->count = 0;
+    f->head = f->tail = 0;
+    f->tx = tx;
+    f->ty = ty;
+    f->version = w->version;
+    f->used = true;
+    unsigned char doors;
+    // an unknown target leaves the field empty: nothing leads there
+    if (world_doors_at(w, tx, ty, &doors)) {
+        path_label(f, tx, ty, 1);
+    }
+}
+/* @
+ * path_field: PathField*
+ * -----------------------
+ * The field of a target, reused while the map is unchanged, otherwise
+ * restarted in its own slot or in the least recently used one.
+ */
+static PathField *path_field(PathCache *cache, World *w, int32_t tx, int32_t ty) {
+    PathField *f = NULL;
+    for (int i = 0; i < PATH_FIELDS && f == NULL; i++) {
+        if (cache->fields[i].used && cache->fields[i].tx == tx && cache->fields[i].ty == ty) {
+            f = &cache->fields[i];
+        }
+    }
+    if (f == NULL) {
+        f = &cache->fields[0];
+        for (int i = 1; i < PATH_FIELDS; i++) {
+            if (!cache->fields[i].used || (f->used && cache->fields[i].last_use < f->last_use)) {
+                f = &cache->fields[i];
+            }
+        }
+        f->used = false;
+    }
+    if (!f->used || f->version != w->version) {
+        path_start(f, w, tx, ty);
+        cache->builds++;
+    }
+    f->last_use = ++cache->uses;
+    return f;
+}
+/* @
+ * path_search: PathNode*
+ * -----------------------
+ * Searches the field outwards until the room at (x, y) has its distance.
+ * A room is only labeled together with all rooms of its distance, so the
+ * result doesn't depend on how far earlier searches went.
+ *
+ * Returns:
+ * - The room's node, or NULL if no known way leads from it to the target.
+ */
+static PathNode *path_search(PathCache *cache, PathField *f, World *w, int32_t x, int32_t y) {
+    PathNode *found = path_find(f, x, y);
+    if (found != NULL) {
+        cache->hits++;
+        return found;
+    }
+    while (f->head < f->tail) {
+        PathPoint b = f->queue[f->head++];
+        uint32_t dist = path_find(f, b.x, b.y)->dist;
+        for (int d = 0; d < 4; d++) {
+            int32_t ax = b.x, ay = b.y;
+            world_step(d, &ax, &ay);
+            unsigned char doors;
+            if (path_find(f, ax, ay) != NULL || !world_doors_at(w, ax, ay, &doors)) {
+                continue;
+            }
+            // the way back from a to b goes through a's opposite door
+            if (!(doors & (1 << ((d + 2) % 4)))) {
+                continue;
+            }
+            if (!path_label(f, ax, ay, dist + 1)) {
+                return NULL;
+            }
+        }
+        found = path_find(f, x, y);
+        if (found != NULL) {
+            return found;
+        }
+    }
+    return NULL;
+}
+/* @
+ * path_distance: uint32_t
+ * ------------------------
+ * Number of rooms to walk from (x, y) to (tx, ty) through known rooms.
+ *
+ * Parameters:
+ * - cache: PathCache* - The session's distance fields.
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Start room.
+ * - tx, ty: int32_t - Target room.
+ *
+ * Returns:
+ * - The number of steps + 1, or 0 if there is no known way.
+ */
+uint32_t path_distance(PathCache *cache, World *w, int32_t x, int32_t y, int32_t tx, int32_t ty) {
+    PathNode *n = path_search(cache, path_field(cache, w, tx, ty), w, x, y);
+    return n != NULL ? n->dist : 0;
+}
+/* @
+ * path_next: int
+ * ---------------
+ * First step of a shortest known way from (x, y) to (tx, ty). Among equally
+ * short ways the lowest direction number wins.
+ *
+ * Parameters:
+ * - cache: PathCache* - The session's distance fields.
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Start room.
+ * - tx, ty: int32_t - Target room.
+ *
+ * Returns:
+ * - The direction to move in (0: west, 1: south, 2: east, 3: north), or -1
+ *   if (x, y) is the target or no known way leads there.
+ */
+int path_next(PathCache *cache, World *w, int32_t x, int32_t y, int32_t tx, int32_t ty) {
+    PathField *f = path_field(cache, w, tx, ty);
+    PathNode *n = path_search(cache, f, w, x, y);
+    unsigned char doors;
+    if (n == NULL || n->dist == 1 || !world_doors_at(w, x, y, &doors)) {
+        return -1;
+    }
+    uint32_t dist = n->dist;
+    for (int d = 0; d < 4; d++) {
+        int32_t nx = x, ny = y;
+        world_step(d, &nx, &ny);
+        PathNode *next = path_find(f, nx, ny);
+        if ((doors & (1 << d)) && next != NULL && next->dist == dist - 1) {
+            return d;
+        }
+    }
+    return -1;
+}
@@ -114,9 +114,10 @@ void player_calculate_stats(Player *pl)
  */
 bool player_check_inv_has(Player *pl, char *arg)
 {
+    NameId name = names_find(arg);
     for (int i = 0; i < PLAYER_INV_SIZE; i++)
     {
-        if (strcasecmp(pl->inventory[i].name, arg) == 0)
+        if (pl->inventory[i].type != ITEM_NONE && pl->inventory[i].name == name)
         {
             return true;
         }
@@ -137,9 +138,10 @@ bool player_check_inv_has(Player *pl, char *arg)
  */
 bool player_drop_item(Player *pl, char *arg)
 {
+    NameId name = names_find(arg);
     for (int i = 0; i < PLAYER_INV_SIZE; i++)
     {
-        if (strcasecmp(pl->inventory[i].name, arg) == 0)
+        if (pl->inventory[i].type != ITEM_NONE && pl->inventory[i].name == name)
         {
             memset(&pl->inventory[i], 0, sizeof(pl->inventory[i]));
             player_calculate_stats(pl);
@@ -209,19 +211,52 @@ bool player_check_has_same(Player *pl)
 {
     for (int i = 0; i < PLAYER_INV_SIZE; i++)
     {
-        if (pl->inventory[i].name == pl->room->item.name && pl->room->item.looted == false)
+        if (pl->inventory[i].type != ITEM_NONE && pl->inventory[i].name == pl->room->item.name && pl->room->item.looted == false)
         {
             return true;
         }
     }
     return false;
 }
+/* @
+ * player_step: bool
+ * ------------------
+ * Moves the player through a door into the neighboring room, which is the
+ * same room as last time if it was visited before (see world.c), and
+ * regenerates their health. Nothing is drawn.
+ *
+ * Parameters:
+ * - pl: Player* - Pointer to the Player structure.
+ * - direction: int - Direction to move (0: left, 1: down, 2: right, 3: up).
+ *
+ * Returns:
+ * - false if there is no door in that direction.
+ */
+static bool player_step(Player *pl, int direction)
+{
+    if ((pl->room->doors & (0b0001 << direction)) == 0)
+    {
+        return false;
+    }
+    // remember what happened here, then enter the neighbor: a room seen
+    // before comes back as it was left, a new one gets its own random stream
+    world_leave(pl->world, pl->x, pl->y, pl->room);
+    world_step(direction, &pl->x, &pl->y);
+    pl->rooms_walked += 1;
+    Room *r = room_pool_acquire(pl->rooms);
+    pl->room_index = world_enter(pl->world, pl->x, pl->y, &pl->rng, r, pl->rooms_walked);
+    room_pool_release(pl->rooms, pl->room);
+    pl->room = r;
+    pl->health = pl->maxHealth;
+    return true;
+}
 /* @
  * player_move: bool
  * -------------------
  * Attempts to move the player in a specified direction. If the direction 
  * contains an enemy, the player will engage in combat. Otherwise, the player
- * will move to a new room.
+ * will move to the neighboring room, which is the same room as last time if
+ * it was visited before (see world.c).
  *
  * Parameters:
  * - pl: Player* - Pointer to the Player structure.
@@ -240,18 +275,12 @@ bool player_move(Player *pl, int direction)
     }
     else
     {
-        if ((pl->room->doors & (0b0001 << direction)) == 0)
+        bool hurt = pl->health != pl->maxHealth;
+        if (!player_step(pl, direction))
         {
             return false;
         }
-        // move direction
-        Room *r = (Room *)malloc(sizeof(Room));
-        room_create_random(r, room_get_door_bit(direction));
-        free(pl->room);
-        pl->room = r;
-        pl->rooms_walked += 1;
-        if(pl->health != pl->maxHealth) {
-            pl->health = pl->maxHealth;
+        if(hurt) {
             draw_output_text("Your health regenerated!");
             draw_player_stats(pl);
         }
@@ -260,6 +289,63 @@ bool player_move(Player *pl, int direction)
     }
     return true;
 }
+/* @
+ * player_goto: int
+ * -----------------
+ * Walks the player to a known room along a shortest way through known rooms
+ * (see path.c), as one action: the rooms on the way are not drawn, only the
+ * one the walk ends in. The walk stops in front of an enemy blocking the way.
+ *
+ * Parameters:
+ * - pl: Player* - Pointer to the Player structure.
+ * - x, y: int32_t - Coordinates of the target room, the first room is (0, 0).
+ *
+ * Returns:
+ * - The number of rooms walked, or -1 if no known way leads there.
+ */
+int player_goto(Player *pl, int32_t x, int32_t y)
+{
+    if (pl->paths == NULL || path_distance(pl->paths, pl->world, pl->x, pl->y, x, y) == 0)
+    {
+        draw_output_text("You don't know a way to (%d, %d)!", (int)x, (int)y);
+        return -1;
+    }
+    bool hurt = pl->health != pl->maxHealth;
+    int steps = 0;
+    int direction;
+    while ((direction = path_next(pl->paths, pl->world, pl->x, pl->y, x, y)) >= 0)
+    {
+        if (pl->room->mobs[direction].type != ENEMY_NONE || !player_step(pl, direction))
+        {
+            break;
+        }
+        steps++;
+    }
+
+    if (steps > 0)
+    {
+        draw_dungeon(pl->room);
+        if (hurt)
+        {
+            draw_player_stats(pl);
+        }
+    }
+    if (direction >= 0 && pl->room->mobs[direction].type != ENEMY_NONE)
+    {
+        draw_output_text("You walked %d rooms, %s blocks the way at (%d, %d)!", steps,
+                         enemy_get_name(pl->room->mobs[direction].type), (int)pl->x, (int)pl->y);
+    }
+    else if (pl->x == x && pl->y == y)
+    {
+        draw_output_text("You walked %d rooms to (%d, %d).%s", steps, (int)x, (int)y,
+                         steps > 0 && hurt ? " Your health regenerated!" : "");
+    }
+    else
+    {
+        draw_output_text("You walked %d rooms and stopped at (%d, %d).", steps, (int)pl->x, (int)pl->y);
+    }
+    return steps;
+}
 /* @
  * player_attack: float
  * ----------------------
@@ -277,9 +363,8 @@ bool player_move(Player *pl, int direction)
 float player_attack(Player *pl, int multiplier)
 {
     float damage = 0;
-    srand(time(0));
 
-    int chance = rand() % 100 + 1;
+    int chance = rng_range(&pl->war_rng, 100) + 1;
     if (chance * multiplier <= pl->crit_chance * 100)
     {
         // crit!
@@ -306,6 +391,63 @@ float player_attack(Player *pl, int multiplier)
 void player_get_hit(Player *pl, float damage) {
     pl->health += (0.25 * pl->defence - damage);
 }
+/* @
+ * player_war_round: WarOutcome
+ * -----------------------------
+ * Plays one round of the current fight: the player's hit or kick and the
+ * enemy's answer, or a flee attempt. Only the game state changes, drawing
+ * is left to the caller, so the same rules drive the game and the combat
+ * simulator (sim/combat_sim.c).
+ *
+ * Parameters:
+ * - pl: Player* - Pointer to the Player structure, fighting pl->room->mobs[pl->warIndex].
+ * - action: WarAction - What the player does.
+ * - dealt: float* - Receives the player's damage (0 when fleeing).
+ * - taken: float* - Receives the enemy's damage (0 if it didn't hit back).
+ *
+ * Returns:
+ * - How the round ended.
+ *
+ * Notes:
+ * - A hit lands twice: player_attack already applies its damage and the
+ *   round applies it once more, as the game always did.
+ * - A killed or escaped enemy is removed from the room and ends the fight.
+ */
+WarOutcome player_war_round(Player *pl, WarAction action, float *dealt, float *taken)
+{
+    Enemy *e = &pl->room->mobs[pl->warIndex];
+    *dealt = 0;
+    *taken = 0;
+    if (action == WAR_FLEE)
+    {
+        int chance = rng_range(&pl->war_rng, 100) + 1;
+        if (chance <= e->flee_chance * 100)
+        {
+            pl->onWar = false;
+            // delete that mob
+            memset(e, 0, sizeof(*e));
+            return WAR_FLED;
+        }
+        e->flee_chance -= 0.1;
+        int e_dmg = enemy_attack(e, &pl->war_rng);
+        player_get_hit(pl, e_dmg);
+        *taken = e_dmg;
+        return WAR_FLEE_FAILED;
+    }
+
+    *dealt = player_attack(pl, action == WAR_KICK ? 2 : 1);
+    enemy_get_hit(e, *dealt);
+    if (!enemy_is_alive(e))
+    {
+        memset(e, 0, sizeof(*e));
+        pl->onWar = false;
+        pl->mobs_killed += 1;
+        return WAR_ENEMY_KILLED;
+    }
+    *taken = enemy_attack(e, &pl->war_rng);
+    player_get_hit(pl, *taken);
+    return player_check_alive(pl) ? WAR_EXCHANGED : WAR_PLAYER_DIED;
+}
 /* @
  * player_init_attack: int
  * -------------------------
@@ -386,7 +528,8 @@ int player_init_attack(Player *pl, char *arg)
  * player_start_attack: void
  * ---------------------------
  * Prepares the player for combat with a specific enemy by setting the war state 
- * and updating the UI with relevant war information.
+ * and updating the UI with relevant war information. The fight gets its own
+ * random stream, keyed by the room index and the enemy's position.
  *
  * Parameters:
  * - pl: Player* - Pointer to the Player structure.
@@ -396,5 +539,6 @@ void player_start_attack(Player *pl, int index)
 {
     pl->onWar = true;
     pl->warIndex = index;
+    rng_fork(&pl->rng, &pl->war_rng, RNG_DOMAIN_FIGHT, (uint64_t)pl->rooms_walked * 4 + index);
     draw_war_info(pl);
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "render.h"
+
+/*
+###################################
+###        ANSI TERMINAL        ###
+###################################
+*/
+/* @
+ * ansi_get_size: void
+ * --------------------
+ * Asks the OS for the terminal size, falling back to 80x24.
+ *
+ * Parameters:
+ * - width: int* - Receives the number of columns.
+ * - height: int* - Receives the number of rows minus one.
+ */
+static void ansi_get_size(int *width, int *height)
+{
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+    {
+        *width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+        *height = csbi.srWindow.Bottom - csbi.srWindow.Top;
+    }
+    else
+    {
+        *width = 80;
+        *height = 24;
+    }
+#else
+    struct winsize w;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0)
+    {
+        *width = w.ws_col;
+        *height = w.ws_row - 1; // -1 idk but OS gives 1 extra
+    }
+    else
+    {
+        *width = 80;
+        *height = 24;
+    }
+#endif
+}
+/* @
+ * ansi_write: void
+ * -----------------
+ * Writes a finished frame update to the terminal in one call.
+ *
+ * Parameters:
+ * - data: const char* - Bytes to send, escape sequences included.
+ * - len: size_t - Number of bytes.
+ */
+static void ansi_write(const char *data, size_t len)
+{
+#ifdef _WIN32
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+#else
+    size_t sent = 0;
+    while (sent < len)
+    {
+        ssize_t n = write(STDOUT_FILENO, data + sent, len - sent);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        sent += n;
+    }
+#endif
+}
+
+const RenderBackend render_backend_ansi = { "ansi", true, ansi_get_size, ansi_write };
+
+/*
+###################################
+###            NULL             ###
+###################################
+*/
+static void null_get_size(int *width, int *height)
+{
+    *width = 80;
+    *height = 24;
+}
+
+static void null_write(const char *data, size_t len)
+{
+    (void)data;
+    (void)len;
+}
+
+const RenderBackend render_backend_null = { "null", false, null_get_size, null_write };
+
+/*
+###################################
+###          RECORDING          ###
+###################################
+*/
+// Everything the recording backend was sent, plus counters for benchmarks.
+static char *recording_buf = NULL;
+static size_t recording_len = 0;
+static size_t recording_cap = 0;
+static size_t recording_total = 0;
+static int recording_writes = 0;
+static int recording_width = 80;
+static int recording_height = 24;
+
+static void recording_get_size(int *width, int *height)
+{
+    *width = recording_width;
+    *height = recording_height;
+}
+/* @
+ * recording_write: void
+ * ----------------------
+ * Appends the frame update to the in-memory recording and counts the call.
+ *
+ * Parameters:
+ * - data: const char* - Bytes the terminal would have received.
+ * - len: size_t - Number of bytes.
+ */
+static void recording_write(const char *data, size_t len)
+{
+    recording_writes++;
+    recording_total += len;
+    if (recording_len + len > recording_cap)
+    {
+        size_t cap = recording_cap ? recording_cap : 4096;
+        while (cap < recording_len + len)
+        {
+            cap *= 2;
+        }
+        char *grown = (char *)realloc(recording_buf, cap);
+        if (grown == NULL)
+        {
+            return;
+        }
+        recording_buf = grown;
+        recording_cap = cap;
+    }
+    memcpy(recording_buf + recording_len, data, len);
+    recording_len += len;
+}
+
+const RenderBackend render_backend_recording = { "recording", true, recording_get_size, recording_write };
+
+/* @
+ * render_recording_set_size: void
+ * --------------------------------
+ * Sets the terminal size the recording backend reports.
+ *
+ * Parameters:
+ * - width: int - Number of columns.
+ * - height: int - Number of rows minus one, like the ANSI backend reports.
+ */
+void render_recording_set_size(int width, int height)
+{
+    recording_width = width;
+    recording_height = height;
+}
+/* @
+ * render_recording_reset: void
+ * -----------------------------
+ * Drops the recorded bytes and zeroes the counters. The buffer is kept.
+ */
+void render_recording_reset()
+{
+    recording_len = 0;
+    recording_total = 0;
+    recording_writes = 0;
+}
+/* @
+ * render_recording_data: const char*
+ * -----------------------------------
+ * Returns the bytes recorded since the last reset.
+ *
+ * Parameters:
+ * - len: size_t* - Receives the number of recorded bytes.
+ */
+const char *render_recording_data(size_t *len)
+{
+    *len = recording_len;
+    return recording_buf;
+}
+
+size_t render_recording_bytes()
+{
+    return recording_total;
+}
+
+int render_recording_writes()
+{
+    return recording_writes;
+}
+
+/* @
+ * render_backend_find: const RenderBackend*
+ * ------------------------------------------
+ * Looks up a backend by its name ("ansi", "null", "recording").
+ *
+ * Returns:
+ * - The backend, or NULL if there is none with that name.
+ */
+const RenderBackend *render_backend_find(const char *name)
+{
+    const RenderBackend *backends[] = { &render_backend_ansi, &render_backend_null, &render_backend_recording };
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+    {
+        if (strcasecmp(backends[i]->name, name) == 0)
+        {
+            return backends[i];
+        }
+    }
+    return NULL;
+}
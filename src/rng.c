@@ -0,0 +1,149 @@
+#include "rng.h"
+
+/* @
+ * rng_seed: void
+ * ---------------
+ * Seeds the generator. The same seed and stream always give the same rolls,
+ * different streams give independent sequences for the same seed.
+ *
+ * Parameters:
+ * - rng: Rng* - Generator to seed.
+ * - seed: uint64_t - Starting point of the sequence.
+ * - stream: uint64_t - Sequence selector.
+ */
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream)
+{
+    rng->counter_mode = false;
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+/* @
+ * rng_seed_from_time: void
+ * -------------------------
+ * Seeds the generator from the wall clock with sub-second resolution, so two
+ * sessions started in the same second still play different dungeons.
+ *
+ * Parameters:
+ * - rng: Rng* - Generator to seed.
+ * - stream: uint64_t - Sequence selector, e.g. something unique to the session.
+ */
+void rng_seed_from_time(Rng *rng, uint64_t stream)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    rng_seed(rng, (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec, stream);
+}
+/* @
+ * rng_seed_counter: void
+ * -----------------------
+ * Puts the generator in counter mode with the given run seed. Rolls are then
+ * derived from (seed, stream, roll index) only, see rng_fork.
+ *
+ * Parameters:
+ * - rng: Rng* - Generator to seed.
+ * - seed: uint64_t - Run seed, e.g. from --seed.
+ */
+void rng_seed_counter(Rng *rng, uint64_t seed)
+{
+    rng->state = 0;
+    rng->inc = 0;
+    rng->counter_mode = true;
+    rng->key = seed;
+    rng->stream = 0;
+    rng->counter = 0;
+}
+/* @
+ * rng_fork: void
+ * ---------------
+ * Creates a generator for one room or one fight.
+ * In counter mode the child keeps the run seed and gets its own stream
+ * (domain + index) starting at roll 0, so it doesn't depend on anything that
+ * happened before. In stream mode the child is seeded from the parent's state
+ * on its own stream. The parent is never advanced in either mode, so forking
+ * the same (domain, index) again gives the same generator, e.g. to rebuild a
+ * room that was visited before.
+ *
+ * Parameters:
+ * - parent: Rng* - Session generator.
+ * - child: Rng* - Receives the new generator.
+ * - domain: RngDomain - What the child is used for.
+ * - index: uint64_t - Which room or fight of that domain.
+ */
+void rng_fork(Rng *parent, Rng *child, RngDomain domain, uint64_t index)
+{
+    if (parent->counter_mode)
+    {
+        rng_seed_counter(child, parent->key);
+        child->stream = ((uint64_t)domain << 56) ^ index;
+        return;
+    }
+    rng_seed(child, parent->state, ((uint64_t)domain << 56) ^ index);
+}
+/* @
+ * philox4x32: void
+ * -----------------
+ * Philox4x32-10 block function: encrypts a 128-bit counter with a 64-bit key.
+ *
+ * Parameters:
+ * - ctr: uint32_t[4] - Counter block, replaced by the output block.
+ * - key: uint64_t - Key.
+ */
+static void philox4x32(uint32_t ctr[4], uint64_t key)
+{
+    uint32_t k0 = (uint32_t)key;
+    uint32_t k1 = (uint32_t)(key >> 32);
+    for (int round = 0; round < 10; round++)
+    {
+        uint64_t p0 = (uint64_t)0xD2511F53u * ctr[0];
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * ctr[2];
+        uint32_t c0 = (uint32_t)(p1 >> 32) ^ ctr[1] ^ k0;
+        uint32_t c2 = (uint32_t)(p0 >> 32) ^ ctr[3] ^ k1;
+        ctr[0] = c0;
+        ctr[1] = (uint32_t)p1;
+        ctr[2] = c2;
+        ctr[3] = (uint32_t)p0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+}
+/* @
+ * rng_next: uint32_t
+ * -------------------
+ * Returns the next 32 random bits: PCG-XSH-RR in stream mode, word
+ * (roll index % 4) of the Philox block (roll index / 4, stream) in counter mode.
+ *
+ * Parameters:
+ * - rng: Rng* - Generator to advance.
+ */
+uint32_t rng_next(Rng *rng)
+{
+    if (rng->counter_mode)
+    {
+        uint64_t block = rng->counter >> 2;
+        uint32_t ctr[4] = { (uint32_t)block, (uint32_t)(block >> 32), (uint32_t)rng->stream, (uint32_t)(rng->stream >> 32) };
+        philox4x32(ctr, rng->key);
+        return ctr[rng->counter++ & 3];
+    }
+    uint64_t old = rng->state;
+    rng->state = old * 6364136223846793005ULL + rng->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+/* @
+ * rng_range: int
+ * ---------------
+ * Returns a random integer in [0, n), the replacement for `rand() % n`.
+ * Uses a multiply-shift instead of a division.
+ *
+ * Parameters:
+ * - rng: Rng* - Generator to advance.
+ * - n: int - Upper bound (exclusive), must be positive.
+ */
+int rng_range(Rng *rng, int n)
+{
+    return (int)(((uint64_t)rng_next(rng) * (uint32_t)n) >> 32);
+}
@@ -1,6 +1,5 @@
 #include "room.h"
 
-char *Room_Names[] = { "Dungeon", "Big", "Small", "Medium", "Haunted", "Rocky", "Cold" };
 /* @
  * room_create_random: void
  * -------------------------
@@ -17,40 +16,84 @@ char *Room_Names[] = { "Dungeon", "Big", "Small", "Medium", "Haunted", "Rocky",
  * Parameters:
  * - r: Room* - Pointer to the Room structure to be initialized.
  * - open_doors: unsigned char - Bitmask indicating which doors should be open.
+ * - rng: Rng* - Random state to roll with.
  */
-void room_create_random(Room *r, unsigned char open_doors){
+void room_create_random(Room *r, unsigned char open_doors, Rng *rng){
     // set all values to 0
     memset(r, 0, sizeof(*r));
-    // SEEDING RANDOM
-    srand(time(0));
     // random doors
-    bool direction_n  = (rand() % 2);
-    bool direction_s  = (rand() % 2);
-    bool direction_e  = (rand() % 2);
-    bool direction_w  = (rand() % 2);
+    bool direction_n  = rng_range(rng, 2);
+    bool direction_s  = rng_range(rng, 2);
+    bool direction_e  = rng_range(rng, 2);
+    bool direction_w  = rng_range(rng, 2);
     // if no door opened, open north door
     if(direction_n + direction_s + direction_e + direction_w <= 0 && open_doors == 0) {
         direction_n = 1;
     }
     // Open doors
-    r->name = room_get_random_name(Room_Names, " Room");
+    r->name = names_random(NAMES_ROOM, rng);
     r->doors = direction_n << 3 | direction_e << 2 | direction_s << 1 | direction_w | open_doors;
     r->searched = false;
     // Put random item
-    item_create_random(&r->item);
+    item_create_random(&r->item, rng);
     // put enemies
-    unsigned char enemyCount = rand() % 5;
+    unsigned char enemyCount = rng_range(rng, 5);
     //enemyCount = 0; // for debugging purposes
     unsigned char i = 0;
     while(i < enemyCount) {
-        unsigned char pos = (unsigned char)(rand() % 4); // random position
+        unsigned char pos = (unsigned char)rng_range(rng, 4); // random position
         if(r->mobs[pos].type == ENEMY_NONE) {
-            enemy_create_random(&r->mobs[pos]);
+            enemy_create_random(&r->mobs[pos], rng);
             i++;
         }
     }
     return;
 }
+/* @
+ * room_pool_reset: void
+ * ----------------------
+ * Marks every slot of the pool as free, e.g. when a new game starts.
+ *
+ * Parameters:
+ * - pool: RoomPool* - The session's room pool.
+ */
+void room_pool_reset(RoomPool *pool){
+    memset(pool->used, 0, sizeof(pool->used));
+}
+/* @
+ * room_pool_acquire: Room*
+ * -------------------------
+ * Takes a free Room slot from the pool.
+ *
+ * Parameters:
+ * - pool: RoomPool* - The session's room pool.
+ *
+ * Returns:
+ * - A Room to fill (e.g. with room_create_random), or NULL if all slots are in use.
+ */
+Room *room_pool_acquire(RoomPool *pool){
+    for(int i = 0; i < ROOM_POOL_SIZE; i++) {
+        if(!pool->used[i]) {
+            pool->used[i] = true;
+            return &pool->rooms[i];
+        }
+    }
+    return NULL;
+}
+/* @
+ * room_pool_release: void
+ * ------------------------
+ * Gives a Room slot back to the pool so the next room transition reuses it.
+ *
+ * Parameters:
+ * - pool: RoomPool* - The session's room pool.
+ * - r: Room* - Room taken from this pool, or NULL.
+ */
+void room_pool_release(RoomPool *pool, Room *r){
+    if(r >= pool->rooms && r < pool->rooms + ROOM_POOL_SIZE) {
+        pool->used[r - pool->rooms] = false;
+    }
+}
 /* @
  * room_look: bool
  * ----------------
@@ -114,74 +157,74 @@ int room_get_enemy_count(Room *r){
     return c;
 }
 /* @
- * room_get_enemy_names: char*
- * ----------------------------
- * Returns a string containing the names of all enemies present in the room.
- * If there are multiple enemies, their names are separated by spaces.
- * The result string is dynamically allocated and must be freed by the caller.
+ * room_get_enemy_names: size_t
+ * -----------------------------
+ * Writes the names of all enemies present in the room into a caller supplied
+ * buffer. If there are multiple enemies, their names are separated by spaces.
  *
  * Parameters:
  * - r: Room* - Pointer to the Room structure.
+ * - buffer: char* - Where the names are written, always null-terminated.
+ * - size: size_t - Size of buffer, ROOM_ENEMY_NAMES_LENGTH fits four enemies.
  *
  * Returns:
- * - A string containing the names of enemies, or NULL if memory allocation fails.
+ * - Length of the written string.
  */
-char* room_get_enemy_names(Room *r) {
-    // Allocate memory for the result string
-    char *result = malloc(100);
-    if (!result) {
-        return NULL;
+size_t room_get_enemy_names(Room *r, char *buffer, size_t size) {
+    size_t length = 0;
+    if (size == 0) {
+        return 0;
     }
-    memset(result, 0, 100);
-
+    buffer[0] = '\0';
     for (int i = 0; i < 4; i++) {
         if (r->mobs[i].type != ENEMY_NONE) {
-            strcat(result, enemy_get_simple_name(r->mobs[i].type));
-            strcat(result, " "); // Add a space between names
+            // Names are static strings, append them with a space between names
+            int written = snprintf(buffer + length, size - length, "%s ", enemy_get_simple_name(r->mobs[i].type));
+            if (written < 0 || (size_t)written >= size - length) {
+                return strlen(buffer);
+            }
+            length += written;
         }
     }
-    return result;
+    return length;
 }
 /* @
- * room_get_open_doors: char*
- * ---------------------------
+ * room_get_open_doors: const char*
+ * ---------------------------------
  * Returns a string describing the open doors in the room. The result string
  * contains the directions of open doors, separated by spaces (e.g., "up right").
- * The result string is dynamically allocated and must be freed by the caller.
+ * All 16 combinations are static strings indexed by the door bits.
  *
  * Parameters:
  * - r: Room* - Pointer to the Room structure.
  *
  * Returns:
- * - A string describing the open doors, or NULL if memory allocation fails.
+ * - A string describing the open doors, must not be freed.
  */
-char* room_get_open_doors(Room *r) {
-    // Allocate memory for the result string
-    char *result = malloc(100);
-    if (!result) {
-        return NULL; // Handle allocation failure
-    }
-    memset(result, 0, 100);
-
-    // Check door directions and append to result
-    if ((r->doors & 0b1000) > 0) {
-        strcat(result, "up ");
-    }
-    if ((r->doors & 0b0100) > 0) {
-        strcat(result, "right ");
-    }
-    if ((r->doors & 0b0010) > 0) {
-        strcat(result, "down ");
-    }
-    if ((r->doors & 0b0001) > 0) {
-        strcat(result, "left ");
-    }
-
-    return result;
+const char* room_get_open_doors(Room *r) {
+    static const char *door_names[16] = {
+        "",                      // 0b0000
+        "left ",                 // 0b0001
+        "down ",                 // 0b0010
+        "down left ",            // 0b0011
+        "right ",                // 0b0100
+        "right left ",           // 0b0101
+        "right down ",           // 0b0110
+        "right down left ",      // 0b0111
+        "up ",                   // 0b1000
+        "up left ",              // 0b1001
+        "up down ",              // 0b1010
+        "up down left ",         // 0b1011
+        "up right ",             // 0b1100
+        "up right left ",        // 0b1101
+        "up right down ",        // 0b1110
+        "up right down left "    // 0b1111
+    };
+    return door_names[r->doors & 0b1111];
 }
 /* @
- * room_get_item_name: char*
- * ---------------------------
+ * room_get_item_name: const char*
+ * ---------------------------------
  * Returns the name of the item in the room. If there is no item or the item
  * has already been looted, returns "NONE".
  *
@@ -191,44 +234,10 @@ char* room_get_open_doors(Room *r) {
  * Returns:
  * - A string representing the item's name, or "NONE" if no item is available.
  */
-char* room_get_item_name(Room *r) {
+const char* room_get_item_name(Room *r) {
     if(r->item.type == ITEM_NONE || r->item.looted) {
         return "NONE";
     } else {
-        return r->item.name;
+        return names_get(r->item.name);
     }
-}
-/* @
- * room_get_random_name: char*
- * ----------------------------
- * Selects a random name for the room from a list of possible names and appends
- * the provided suffix to it.
- *
- * Parameters:
- * - list: char*[] - List of possible room names.
- * - last: char* - Suffix to be appended to the selected name.
- *
- * Returns:
- * - A dynamically allocated string containing the room's name, or NULL if memory allocation fails.
- */
-char *room_get_random_name(char* list[], char* last) {
-    int list_size = 0;
-    while (list[list_size] != NULL) {
-        list_size++;
-    }
-
-    int random_index = rand() % list_size;
-
-    char* selected_string = list[random_index];
-
-    size_t result_length = strlen(selected_string) + strlen(last) + 1;
-    char* result = (char*)malloc(result_length * sizeof(char));
-
-    if (!result) {
-        return NULL;
-    }
-    strcpy(result, selected_string);
-    strcat(result, last);
-
-    return result;
 }
\ No newline at end of file
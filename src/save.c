@@ -1,152 +1,1503 @@
 #include "save.h"
 
-void save_player(Player *player, char *filename) {
-    char f[50];
-    sprintf(f, "save_%s.dat", filename);
-    FILE *file = fopen(f, "wb");
-    if (file == NULL) {
-        perror("The file can not be opened.");
-        return;
-    }
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <pthread.h>
+    #include <signal.h>
+#endif
 
-    // save player struct without pointers
-    fwrite(player, sizeof(Player) - sizeof(Room *) - sizeof(char *), 1, file);
-
-    // save room
-    if (player->room) {
-        short hasRoom = 1; // do we have room?
-        fwrite(&hasRoom, sizeof(short), 1, file);
-
-        // save room data
-        fwrite(player->room, sizeof(Room), 1, file);
-
-        // save the pointers in the room data
-        int nameLen = strlen(player->room->name) + 1;
-        int itemNameLen = strlen(player->room->item.name) + 1;
-        fwrite(&nameLen, sizeof(int), 1, file);
-        fwrite(player->room->name, sizeof(char), nameLen, file);
-        fwrite(&itemNameLen, sizeof(int), 1, file);
-        fwrite(player->room->item.name, sizeof(char), itemNameLen, file);
-        // save item names
-        for(int i = 0; i < PLAYER_INV_SIZE; i++) {
-            if(player->inventory[i].name != NULL) {
-                int invItemNameLen = strlen(player->inventory[i].name) + 1;
-                fwrite(&invItemNameLen, sizeof(int), 1, file);
-                fwrite(player->inventory[i].name, sizeof(char), invItemNameLen, file);
+// Save file layout (version 1), every number little-endian:
+//   header : magic "AYBU" | u16 version | u16 section count | u32 payload length | u32 CRC32 of payload
+//   payload: sections, each u8 tag | u16 length | data
+//   SAVE_SECTION_PLAYER: stats, counters, fight state and the used inventory slots
+//   SAVE_SECTION_RNG   : session and fight random states
+//   SAVE_SECTION_ROOM  : current room and its living enemies
+//   SAVE_SECTION_WORLD : position and generation index of the current room, then whether
+//                        the world is procedural (optional, older saves start at (0, 0)
+//                        in a stored world)
+//   SAVE_SECTION_MAP   : (optional, older saves only know the current room)
+//                        u64 world seed | u32 next generation index | u32 frontier |
+//                        u8 rooms were forgotten | u8 empty mob slots and u32 visit of the
+//                        current room on entry | u32 stored rooms | u32 chunks left in the
+//                        chunk file (optional, only snapshots refer to it)
+//   SAVE_SECTION_ROOMS : after SAVE_SECTION_MAP, up to SAVE_MAP_ROOMS stored rooms, each
+//                        i32 x | i32 y | u32 generation index | u32 last visit | u8 doors | u8 state
+//   SAVE_SECTION_SPILLED: after SAVE_SECTION_MAP, up to SAVE_MAP_SPILLED chunks whose rooms
+//                        are in the session's chunk file, each
+//                        i32 cx | i32 cy | u32 record number + 1 | u16 used rooms
+// Floats are stored as their IEEE-754 bits, empty slots and dead enemies are skipped.
+#define SAVE_MAGIC "AYBU"
+#define SAVE_VERSION 1
+#define SAVE_HEADER_SIZE 16
+#define SAVE_SECTION_HEADER_SIZE 3
+#define SAVE_MAP_ROOM_SIZE 18
+// Stored rooms per SAVE_SECTION_ROOMS, so its length fits the u16
+#define SAVE_MAP_ROOMS 2048
+#define SAVE_MAP_SPILLED_SIZE 14
+#define SAVE_MAP_SPILLED 2048
+// Buffer save_encode_file stages a section in: the largest one is a full
+// SAVE_SECTION_ROOMS
+#define SAVE_STAGE_SIZE (SAVE_SECTION_HEADER_SIZE + SAVE_MAP_ROOMS * SAVE_MAP_ROOM_SIZE)
+
+typedef enum {
+    SAVE_SECTION_PLAYER = 1,
+    SAVE_SECTION_RNG,
+    SAVE_SECTION_ROOM,
+    SAVE_SECTION_WORLD,
+    SAVE_SECTION_MAP,
+    SAVE_SECTION_ROOMS,
+    SAVE_SECTION_SPILLED
+} SaveSection;
+
+// Cursor over a save buffer. Any out of bounds access clears ok, so the
+// field readers and writers can be chained and checked once at the end.
+typedef struct SaveBuffer {
+    unsigned char *data;
+    size_t size;
+    size_t pos;
+    bool ok;
+} SaveBuffer;
+
+// Where save_emit writes. Without a file the whole save is built in b, with
+// one b holds a section at a time, written out as soon as it is complete.
+typedef struct SaveSink {
+    SaveBuffer b;
+    FILE *file;
+    size_t written;  // bytes written to the file, header included
+    size_t checked;  // bytes of b already in crc
+    uint32_t crc;    // CRC32 of the payload so far
+    size_t sections;
+    size_t rooms;    // SAVE_SECTION_ROOMS started at b.pos - rooms * SAVE_MAP_ROOM_SIZE
+    int error;       // errno of a failed write or chunk read
+} SaveSink;
+
+/* @
+ * save_crc32_update: uint32_t
+ * ----------------------------
+ * Extends the CRC32 (IEEE, reflected) of some bytes with the bytes that follow
+ * them. The table is built on first use.
+ *
+ * Parameters:
+ * - crc: uint32_t - CRC32 of the bytes so far, 0 for none.
+ * - data: const unsigned char* - Bytes to add.
+ * - size: size_t - Number of bytes.
+ */
+static uint32_t save_crc32_update(uint32_t crc, const unsigned char *data, size_t size) {
+    static uint32_t table[256];
+    static bool table_ready = false;
+    if (!table_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
             }
+            table[i] = c;
         }
+        table_ready = true;
+    }
+    crc ^= 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/* @
+ * save_crc32: uint32_t
+ * ---------------------
+ * Computes the CRC32 (IEEE, reflected) of a byte range.
+ *
+ * Parameters:
+ * - data: const unsigned char* - Bytes to check.
+ * - size: size_t - Number of bytes.
+ */
+uint32_t save_crc32(const unsigned char *data, size_t size) {
+    return save_crc32_update(0, data, size);
+}
+
+static unsigned char *save_take(SaveBuffer *b, size_t n) {
+    if (!b->ok || b->size - b->pos < n) {
+        b->ok = false;
+        return NULL;
+    }
+    unsigned char *p = b->data + b->pos;
+    b->pos += n;
+    return p;
+}
+
+static void put_uint(SaveBuffer *b, uint64_t value, size_t n) {
+    unsigned char *p = save_take(b, n);
+    for (size_t i = 0; p && i < n; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_uint(SaveBuffer *b, size_t n) {
+    unsigned char *p = save_take(b, n);
+    uint64_t value = 0;
+    for (size_t i = 0; p && i < n; i++) {
+        value |= (uint64_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+static void put_float(SaveBuffer *b, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_uint(b, bits, 4);
+}
+
+static float get_float(SaveBuffer *b) {
+    uint32_t bits = (uint32_t)get_uint(b, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Sections are written with a placeholder length that is patched once the data is in.
+static size_t section_begin(SaveBuffer *b, SaveSection tag) {
+    put_uint(b, tag, 1);
+    put_uint(b, 0, 2);
+    return b->pos;
+}
+
+static void section_end(SaveBuffer *b, size_t start) {
+    if (b->ok) {
+        size_t length = b->pos - start;
+        b->data[start - 2] = (unsigned char)length;
+        b->data[start - 1] = (unsigned char)(length >> 8);
+    }
+}
+
+static void put_item(SaveBuffer *b, Item *i) {
+    put_uint(b, i->type, 1);
+    put_uint(b, i->name, 1);
+    put_uint(b, i->looted, 1);
+    put_float(b, i->health);
+    put_float(b, i->strength);
+    put_float(b, i->defence);
+    put_float(b, i->crit_rate);
+    put_float(b, i->crit_chance);
+}
+
+static bool get_item(SaveBuffer *b, Item *i) {
+    memset(i, 0, sizeof(*i));
+    i->type = (int)get_uint(b, 1);
+    i->name = (NameId)get_uint(b, 1);
+    i->looted = get_uint(b, 1) != 0;
+    i->health = get_float(b);
+    i->strength = get_float(b);
+    i->defence = get_float(b);
+    i->crit_rate = get_float(b);
+    i->crit_chance = get_float(b);
+    return b->ok && i->type >= ITEM_NONE && i->type <= ITEM_GENERAL
+        && (i->type == ITEM_NONE || names_get(i->name)[0] != '\0');
+}
+
+// Only the fields the generator's mode actually uses are stored.
+static void put_rng(SaveBuffer *b, Rng *rng) {
+    put_uint(b, rng->counter_mode, 1);
+    if (rng->counter_mode) {
+        put_uint(b, rng->key, 8);
+        put_uint(b, rng->stream, 8);
+        put_uint(b, rng->counter, 8);
     } else {
-        short hasRoom = 0; // no room
-        fwrite(&hasRoom, sizeof(short), 1, file);
+        put_uint(b, rng->state, 8);
+        put_uint(b, rng->inc, 8);
     }
+}
 
-    fclose(file);
-    printf("Game successfully saved to: '%s'!", f);
+static void get_rng(SaveBuffer *b, Rng *rng) {
+    memset(rng, 0, sizeof(*rng));
+    rng->counter_mode = get_uint(b, 1) != 0;
+    if (rng->counter_mode) {
+        rng->key = get_uint(b, 8);
+        rng->stream = get_uint(b, 8);
+        rng->counter = get_uint(b, 8);
+    } else {
+        rng->state = get_uint(b, 8);
+        rng->inc = get_uint(b, 8);
+    }
 }
 
-void load_player(Player *player, char *filename) {
-    char f[50];
-    sprintf(f, "save_%s.dat", filename);
-    FILE *file = fopen(f, "rb");
-    if (file == NULL) {
-        perror("The file can not be opened.");
-        return;
+static void put_world_room(SaveBuffer *b, WorldRoom *rec) {
+    put_uint(b, (uint32_t)rec->x, 4);
+    put_uint(b, (uint32_t)rec->y, 4);
+    put_uint(b, rec->index, 4);
+    put_uint(b, rec->last_visit, 4);
+    put_uint(b, rec->doors, 1);
+    put_uint(b, rec->state, 1);
+}
+
+static bool get_world_room(SaveBuffer *b, WorldRoom *rec) {
+    rec->x = (int32_t)(uint32_t)get_uint(b, 4);
+    rec->y = (int32_t)(uint32_t)get_uint(b, 4);
+    rec->index = (uint32_t)get_uint(b, 4);
+    rec->last_visit = (uint32_t)get_uint(b, 4);
+    rec->doors = (unsigned char)get_uint(b, 1);
+    rec->state = (unsigned char)get_uint(b, 1);
+    return b->ok && rec->doors <= 0b1111 && (rec->state & WORLD_ROOM_USED);
+}
+
+/* @
+ * save_size: size_t
+ * ------------------
+ * Size of a buffer that always holds an encoded save of a game with this map.
+ */
+static size_t save_size(WorldImage *world) {
+    size_t rooms = world->count, spilled = 0;
+    for (uint32_t i = 0; i < world->spilled_count; i++) {
+        if (world->references) {
+            spilled++;
+        } else {
+            rooms += world->spilled[i].count;
+        }
     }
+    size_t sections = (rooms + SAVE_MAP_ROOMS - 1) / SAVE_MAP_ROOMS + (spilled + SAVE_MAP_SPILLED - 1) / SAVE_MAP_SPILLED;
+    return SAVE_MAX_SIZE + sections * SAVE_SECTION_HEADER_SIZE + rooms * SAVE_MAP_ROOM_SIZE + spilled * SAVE_MAP_SPILLED_SIZE;
+}
 
-    // read player struct without pointers
-    fread(player, sizeof(Player) - sizeof(Room *) - sizeof(char *), 1, file);
+/* @
+ * save_section_done: void
+ * ------------------------
+ * Closes a section: patches its length, adds it to the payload checksum and,
+ * when writing to a file, writes it out to make room for the next one.
+ */
+static void save_section_done(SaveSink *s, size_t section) {
+    section_end(&s->b, section);
+    s->sections++;
+    if (!s->b.ok) {
+        return;
+    }
+    s->crc = save_crc32_update(s->crc, s->b.data + s->checked, s->b.pos - s->checked);
+    s->checked = s->b.pos;
+    if (s->file != NULL) {
+        if (fwrite(s->b.data, 1, s->b.pos, s->file) != s->b.pos) {
+            s->error = errno != 0 ? errno : EIO;
+            s->b.ok = false;
+        }
+        s->written += s->b.pos;
+        s->b.pos = s->checked = 0;
+    }
+}
 
-    // check if we have room
-    short hasRoom;
-    fread(&hasRoom, sizeof(short), 1, file);
+/* @
+ * save_put_room: void
+ * --------------------
+ * Adds a stored room to the save, in SAVE_SECTION_ROOMS of up to SAVE_MAP_ROOMS.
+ */
+static void save_put_room(SaveSink *s, WorldRoom *rec) {
+    if (s->rooms == 0) {
+        section_begin(&s->b, SAVE_SECTION_ROOMS);
+    }
+    put_world_room(&s->b, rec);
+    if (++s->rooms == SAVE_MAP_ROOMS) {
+        save_section_done(s, s->b.pos - s->rooms * SAVE_MAP_ROOM_SIZE);
+        s->rooms = 0;
+    }
+}
 
-    if (hasRoom) {
-        // allocate memory for room
-        player->room = malloc(sizeof(Room));
-        if (player->room == NULL) {
-            perror("Can't allocate memory!");
-            fclose(file);
-            return;
+/* @
+ * save_emit: bool
+ * ----------------
+ * Does the work of save_encode and save_encode_file: every section after the
+ * header, the spilled chunks of the map read back one at a time (or only
+ * referred to, for an image with references set).
+ *
+ * Returns:
+ * - false with errno set (EFBIG if the save doesn't fit, or why a chunk or
+ *   the file could not be read or written).
+ */
+static bool save_emit(SaveSink *s, Player *player, WorldImage *world) {
+    size_t section = section_begin(&s->b, SAVE_SECTION_PLAYER);
+    put_float(&s->b, player->health);
+    put_float(&s->b, player->maxHealth);
+    put_float(&s->b, player->strength);
+    put_float(&s->b, player->defence);
+    put_float(&s->b, player->crit_rate);
+    put_float(&s->b, player->crit_chance);
+    put_uint(&s->b, (uint32_t)player->rooms_walked, 4);
+    put_uint(&s->b, (uint32_t)player->mobs_killed, 4);
+    put_uint(&s->b, player->onWar, 1);
+    put_uint(&s->b, (unsigned char)player->warIndex, 1);
+    unsigned char used = 0;
+    for (int i = 0; i < PLAYER_INV_SIZE; i++) {
+        if (player->inventory[i].type != ITEM_NONE) {
+            used |= 1 << i;
+        }
+    }
+    put_uint(&s->b, used, 1);
+    for (int i = 0; i < PLAYER_INV_SIZE; i++) {
+        if (used & (1 << i)) {
+            put_item(&s->b, &player->inventory[i]);
         }
+    }
+    save_section_done(s, section);
 
-        // read room data
-        fread(player->room, sizeof(Room), 1, file);
+    section = section_begin(&s->b, SAVE_SECTION_RNG);
+    put_rng(&s->b, &player->rng);
+    put_rng(&s->b, &player->war_rng);
+    save_section_done(s, section);
+
+    Room *r = player->room;
+    section = section_begin(&s->b, SAVE_SECTION_ROOM);
+    put_uint(&s->b, (unsigned char)r->doors, 1);
+    put_uint(&s->b, r->searched, 1);
+    put_uint(&s->b, r->name, 1);
+    put_item(&s->b, &r->item);
+    unsigned char mobs = 0;
+    for (int i = 0; i < 4; i++) {
+        if (r->mobs[i].type != ENEMY_NONE) {
+            mobs |= 1 << i;
+        }
+    }
+    put_uint(&s->b, mobs, 1);
+    for (int i = 0; i < 4; i++) {
+        if (mobs & (1 << i)) {
+            Enemy *e = &r->mobs[i];
+            put_uint(&s->b, e->type, 1);
+            put_float(&s->b, e->health);
+            put_float(&s->b, e->damage);
+            put_float(&s->b, e->crit_rate);
+            put_float(&s->b, e->crit_chance);
+            put_float(&s->b, e->flee_chance);
+        }
+    }
+    save_section_done(s, section);
 
-        // read room name char* in room
-        int nameLen;
-        fread(&nameLen, sizeof(int), 1, file);
+    section = section_begin(&s->b, SAVE_SECTION_WORLD);
+    put_uint(&s->b, (uint32_t)player->x, 4);
+    put_uint(&s->b, (uint32_t)player->y, 4);
+    put_uint(&s->b, player->room_index, 4);
+    put_uint(&s->b, world->procedural, 1);
+    save_section_done(s, section);
 
-        player->room->name = malloc(nameLen);
-        if (player->room->name == NULL) {
-            perror("Can't allocate memory!");
-            fclose(file);
-            return;
+    if (world->map) {
+        uint32_t rooms = world->count;
+        uint32_t spilled = world->references ? world->spilled_count : 0;
+        for (uint32_t i = 0; i < world->spilled_count && !world->references; i++) {
+            rooms += world->spilled[i].count;
+        }
+        section = section_begin(&s->b, SAVE_SECTION_MAP);
+        put_uint(&s->b, world->seed, 8);
+        put_uint(&s->b, world->next_index, 4);
+        put_uint(&s->b, world->frontier, 4);
+        put_uint(&s->b, world->forgot, 1);
+        put_uint(&s->b, world->entered_mobs, 1);
+        put_uint(&s->b, world->entered_visit, 4);
+        put_uint(&s->b, rooms, 4);
+        if (spilled > 0) {
+            put_uint(&s->b, spilled, 4);
+        }
+        save_section_done(s, section);
+        for (uint32_t i = 0; i < world->count; i++) {
+            save_put_room(s, &world->rooms[i]);
+        }
+        if (!world->references && world->spilled_count > 0) {
+            WorldChunk *c = malloc(sizeof(WorldChunk));
+            if (c == NULL) {
+                s->error = ENOMEM;
+                s->b.ok = false;
+            }
+            for (uint32_t i = 0; s->b.ok && i < world->spilled_count; i++) {
+                if (!world_image_read(world, i, c)) {
+                    // a save without some of its rooms is no save
+                    s->error = EIO;
+                    s->b.ok = false;
+                }
+                for (int k = 0; s->b.ok && k < WORLD_CHUNK_ROOMS; k++) {
+                    if (c->rooms[k].state & WORLD_ROOM_USED) {
+                        save_put_room(s, &c->rooms[k]);
+                    }
+                }
+            }
+            free(c);
+        }
+        if (s->rooms > 0) {
+            save_section_done(s, s->b.pos - s->rooms * SAVE_MAP_ROOM_SIZE);
+        }
+        for (uint32_t i = 0; i < spilled; i += SAVE_MAP_SPILLED) {
+            section = section_begin(&s->b, SAVE_SECTION_SPILLED);
+            for (uint32_t k = i; k < spilled && k - i < SAVE_MAP_SPILLED; k++) {
+                WorldSpilled *e = &world->spilled[k];
+                put_uint(&s->b, (uint32_t)e->cx, 4);
+                put_uint(&s->b, (uint32_t)e->cy, 4);
+                put_uint(&s->b, e->record, 4);
+                put_uint(&s->b, e->count, 2);
+            }
+            save_section_done(s, section);
         }
-        fread(player->room->name, sizeof(char), nameLen, file);
-        // read item name char* in room
-        int itemNameLen;
-        fread(&itemNameLen, sizeof(int), 1, file);
+    }
 
-        player->room->item.name = malloc(itemNameLen);
-        if (player->room->item.name == NULL) {
-            perror("Can't allocate memory!");
-            fclose(file);
-            return;
+    if (!s->b.ok || s->sections > 0xFFFF) {
+        errno = s->error != 0 ? s->error : EFBIG;
+        return false;
+    }
+    return true;
+}
+
+static void save_header(unsigned char *header, size_t sections, size_t length, uint32_t crc) {
+    SaveBuffer b = { header, SAVE_HEADER_SIZE, 0, true };
+    memcpy(save_take(&b, 4), SAVE_MAGIC, 4);
+    put_uint(&b, SAVE_VERSION, 2);
+    put_uint(&b, sections, 2);
+    put_uint(&b, length, 4);
+    put_uint(&b, crc, 4);
+}
+
+/* @
+ * save_encode: size_t
+ * --------------------
+ * Serializes the player, its random states, the current room and the world
+ * map into a buffer. Only player->room is followed, the map comes from an
+ * image, so the writer thread can encode a game the game thread copied.
+ *
+ * Parameters:
+ * - player: Player* - Game state to save, player->room must be set.
+ * - world: WorldImage* - The world map, from world_export.
+ * - data: unsigned char* - Output buffer.
+ * - size: size_t - Size of data.
+ *
+ * Returns:
+ * - Number of bytes written, 0 with errno set if it failed (EFBIG: the
+ *   buffer is too small).
+ */
+size_t save_encode(Player *player, WorldImage *world, unsigned char *data, size_t size) {
+    SaveSink s;
+    memset(&s, 0, sizeof(s));
+    s.b = (SaveBuffer){ data, size, SAVE_HEADER_SIZE, size >= SAVE_HEADER_SIZE };
+    s.checked = SAVE_HEADER_SIZE;
+    if (!save_emit(&s, player, world)) {
+        return 0;
+    }
+    save_header(data, s.sections, s.b.pos - SAVE_HEADER_SIZE, s.crc);
+    return s.b.pos;
+}
+
+/* @
+ * save_encode_file: size_t
+ * -------------------------
+ * Like save_encode, but writes the save to a file at its current position,
+ * one section at a time: however big the map, only one section is in memory.
+ * The header is written last.
+ *
+ * Parameters:
+ * - player: Player* - Game state to save, player->room must be set.
+ * - world: WorldImage* - The world map, from world_export.
+ * - file: FILE* - Open for writing (and seeking).
+ *
+ * Returns:
+ * - Number of bytes written, 0 with errno set if it failed.
+ */
+size_t save_encode_file(Player *player, WorldImage *world, FILE *file) {
+    size_t stage = save_size(world);
+    if (stage > SAVE_STAGE_SIZE) {
+        stage = SAVE_STAGE_SIZE;
+    }
+    SaveSink s;
+    memset(&s, 0, sizeof(s));
+    s.file = file;
+    s.b = (SaveBuffer){ malloc(stage), stage, 0, true };
+    if (s.b.data == NULL) {
+        errno = ENOMEM;
+        return 0;
+    }
+    unsigned char header[SAVE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    long start = ftell(file);
+    bool ok = start >= 0 && fwrite(header, 1, SAVE_HEADER_SIZE, file) == SAVE_HEADER_SIZE;
+    s.written = SAVE_HEADER_SIZE;
+    ok = ok && save_emit(&s, player, world);
+    free(s.b.data);
+    if (ok && s.written - SAVE_HEADER_SIZE > 0xFFFFFFFFu) {
+        errno = EFBIG;
+        ok = false;
+    }
+    if (ok) {
+        save_header(header, s.sections, s.written - SAVE_HEADER_SIZE, s.crc);
+        ok = fseek(file, start, SEEK_SET) == 0 && fwrite(header, 1, SAVE_HEADER_SIZE, file) == SAVE_HEADER_SIZE
+            && fseek(file, 0, SEEK_END) == 0;
+    }
+    return ok ? s.written : 0;
+}
+
+/* @
+ * save_parse: bool
+ * -----------------
+ * Does the work of save_decode. The map's rooms may be allocated even when
+ * it fails.
+ */
+static bool save_parse(unsigned char *data, size_t size, Player *player, Room *room, WorldImage *world) {
+    SaveBuffer b = { data, size, 0, true };
+    unsigned char *magic = save_take(&b, 4);
+    if (magic == NULL || memcmp(magic, SAVE_MAGIC, 4) != 0) {
+        return false;
+    }
+    unsigned int version = (unsigned int)get_uint(&b, 2);
+    unsigned int sections = (unsigned int)get_uint(&b, 2);
+    uint32_t length = (uint32_t)get_uint(&b, 4);
+    uint32_t crc = (uint32_t)get_uint(&b, 4);
+    if (!b.ok || version != SAVE_VERSION || length != size - SAVE_HEADER_SIZE
+        || crc != save_crc32(data + SAVE_HEADER_SIZE, length)) {
+        return false;
+    }
+
+    Player p;
+    Room r;
+    memset(&p, 0, sizeof(p));
+    memset(&r, 0, sizeof(r));
+    uint32_t rooms = 0, spilled = 0;
+    unsigned char seen = 0;
+    for (unsigned int s = 0; s < sections; s++) {
+        unsigned int tag = (unsigned int)get_uint(&b, 1);
+        size_t section_length = (size_t)get_uint(&b, 2);
+        if (!b.ok || section_length > size - b.pos) {
+            return false;
+        }
+        // parse each section on its own window, so its length is checked exactly
+        SaveBuffer w = { data + b.pos, section_length, 0, true };
+        b.pos += section_length;
+        switch (tag) {
+            case SAVE_SECTION_PLAYER: {
+                p.health = get_float(&w);
+                p.maxHealth = get_float(&w);
+                p.strength = get_float(&w);
+                p.defence = get_float(&w);
+                p.crit_rate = get_float(&w);
+                p.crit_chance = get_float(&w);
+                p.rooms_walked = (int)(uint32_t)get_uint(&w, 4);
+                p.mobs_killed = (int)(uint32_t)get_uint(&w, 4);
+                p.onWar = get_uint(&w, 1) != 0;
+                p.warIndex = (int)get_uint(&w, 1);
+                unsigned char used = (unsigned char)get_uint(&w, 1);
+                if (p.warIndex >= 4 || used >> PLAYER_INV_SIZE) {
+                    return false;
+                }
+                for (int i = 0; i < PLAYER_INV_SIZE; i++) {
+                    if ((used & (1 << i)) && (!get_item(&w, &p.inventory[i]) || p.inventory[i].type == ITEM_NONE)) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case SAVE_SECTION_RNG:
+                get_rng(&w, &p.rng);
+                get_rng(&w, &p.war_rng);
+                break;
+            case SAVE_SECTION_ROOM: {
+                r.doors = (short)get_uint(&w, 1);
+                r.searched = get_uint(&w, 1) != 0;
+                r.name = (NameId)get_uint(&w, 1);
+                unsigned char mobs = 0;
+                if (!get_item(&w, &r.item)) {
+                    return false;
+                }
+                mobs = (unsigned char)get_uint(&w, 1);
+                if (r.doors > 0b1111 || names_get(r.name)[0] == '\0' || mobs >> 4) {
+                    return false;
+                }
+                for (int i = 0; i < 4; i++) {
+                    if (mobs & (1 << i)) {
+                        Enemy *e = &r.mobs[i];
+                        e->type = (unsigned char)get_uint(&w, 1);
+                        e->health = get_float(&w);
+                        e->damage = get_float(&w);
+                        e->crit_rate = get_float(&w);
+                        e->crit_chance = get_float(&w);
+                        e->flee_chance = get_float(&w);
+                        if (e->type == ENEMY_NONE || e->type > ENEMY_SKELETON) {
+                            return false;
+                        }
+                    }
+                }
+                break;
+            }
+            case SAVE_SECTION_WORLD:
+                p.x = (int32_t)(uint32_t)get_uint(&w, 4);
+                p.y = (int32_t)(uint32_t)get_uint(&w, 4);
+                p.room_index = (uint32_t)get_uint(&w, 4);
+                world->procedural = w.pos < w.size && get_uint(&w, 1) != 0;
+                break;
+            case SAVE_SECTION_MAP:
+                world->seed = get_uint(&w, 8);
+                world->next_index = (uint32_t)get_uint(&w, 4);
+                world->frontier = (uint32_t)get_uint(&w, 4);
+                world->forgot = get_uint(&w, 1) != 0;
+                world->entered_mobs = (unsigned char)get_uint(&w, 1);
+                world->entered_visit = (uint32_t)get_uint(&w, 4);
+                world->count = (uint32_t)get_uint(&w, 4);
+                world->spilled_count = w.pos < w.size ? (uint32_t)get_uint(&w, 4) : 0;
+                // the rooms must fit in the rest of the file before anything is allocated
+                if (!w.ok || world->map || world->count > (size - b.pos) / SAVE_MAP_ROOM_SIZE
+                    || world->spilled_count > (size - b.pos) / SAVE_MAP_SPILLED_SIZE) {
+                    return false;
+                }
+                if ((world->count > 0 && (world->rooms = malloc(world->count * sizeof(WorldRoom))) == NULL)
+                    || (world->spilled_count > 0
+                        && (world->spilled = malloc(world->spilled_count * sizeof(WorldSpilled))) == NULL)) {
+                    return false;
+                }
+                world->map = true;
+                break;
+            case SAVE_SECTION_ROOMS:
+                if (!world->map) {
+                    return false;
+                }
+                while (w.pos < w.size) {
+                    if (rooms == world->count || !get_world_room(&w, &world->rooms[rooms])) {
+                        return false;
+                    }
+                    rooms++;
+                }
+                break;
+            case SAVE_SECTION_SPILLED:
+                if (!world->map) {
+                    return false;
+                }
+                while (w.pos < w.size) {
+                    if (spilled == world->spilled_count) {
+                        return false;
+                    }
+                    WorldSpilled *e = &world->spilled[spilled++];
+                    e->cx = (int32_t)(uint32_t)get_uint(&w, 4);
+                    e->cy = (int32_t)(uint32_t)get_uint(&w, 4);
+                    e->record = (uint32_t)get_uint(&w, 4);
+                    e->count = (uint16_t)get_uint(&w, 2);
+                    if (!w.ok || e->record == 0 || e->count > WORLD_CHUNK_ROOMS) {
+                        return false;
+                    }
+                }
+                break;
+            default:
+                // unknown sections from newer minor revisions are skipped
+                continue;
         }
-        fread(player->room->item.name, sizeof(char), itemNameLen, file);
-        // read item names
-        for(int i = 0; i < PLAYER_INV_SIZE; i++) {
-            int invItemNameLen;
-            fread(&invItemNameLen, sizeof(int), 1, file);
-            player->inventory[i].name = malloc(invItemNameLen);
-            fread(player->inventory[i].name, sizeof(char), invItemNameLen, file);
+        if (!w.ok || w.pos != w.size) {
+            return false;
         }
-    } else {
-        player->room = NULL; // if no room
+        seen |= 1 << tag;
+    }
+    unsigned char required = (1 << SAVE_SECTION_PLAYER) | (1 << SAVE_SECTION_RNG) | (1 << SAVE_SECTION_ROOM);
+    if (b.pos != size || (seen & required) != required || rooms != world->count || spilled != world->spilled_count) {
+        return false;
+    }
+    if (p.onWar && r.mobs[p.warIndex].type == ENEMY_NONE) {
+        return false;
     }
+    *player = p;
+    *room = r;
+    return true;
+}
 
+/* @
+ * save_decode: bool
+ * ------------------
+ * Parses and validates a save buffer into temporaries. Nothing is written
+ * unless the whole file is valid, so a bad file never touches the game.
+ *
+ * Parameters:
+ * - data: unsigned char* - Save file contents.
+ * - size: size_t - Number of bytes in data.
+ * - player: Player* - Receives the player fields (not rooms/room).
+ * - room: Room* - Receives the saved room.
+ * - world: WorldImage* - Receives the saved map, release it with world_image_free.
+ *   Without SAVE_SECTION_MAP only world->procedural is set. The chunks of a
+ *   snapshot that are in the chunk file are in world->spilled.
+ *
+ * Returns:
+ * - true if the buffer is a complete, uncorrupted save of a known version.
+ */
+static bool save_decode(unsigned char *data, size_t size, Player *player, Room *room, WorldImage *world) {
+    memset(world, 0, sizeof(*world));
+    if (!save_parse(data, size, player, room, world)) {
+        world_image_free(world);
+        return false;
+    }
+    return true;
+}
+
+/* @
+ * save_read_file: unsigned char*
+ * -------------------------------
+ * Reads a whole file into memory, e.g. a save or a snapshot.
+ *
+ * Parameters:
+ * - path: const char* - The file.
+ * - size: size_t* - Receives the number of bytes read.
+ *
+ * Returns:
+ * - The contents (free them), or NULL with errno set if the file can't be read.
+ */
+unsigned char *save_read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    unsigned char *data = NULL;
+    if (length >= 0 && fseek(file, 0, SEEK_SET) == 0 && (data = malloc((size_t)length + 1)) != NULL) {
+        *size = fread(data, 1, (size_t)length, file);
+        if (*size != (size_t)length) {
+            free(data);
+            data = NULL;
+            errno = EIO;
+        }
+    }
     fclose(file);
-    printf("The game loaded from '%s'!", f);
+    return data;
+}
+
+// Save catalog: one fixed-size little-endian record per save, so `list`
+// never has to scan the directory or open the saves themselves.
+//   header : magic "AYBI" | u16 version | u16 record size | u32 record count | u32 reserved
+//   record : name[40] | u32 file size | u64 mtime | u32 rooms_walked | u32 mobs_killed | u32 reserved
+#define SAVE_INDEX_FILE "saves.idx"
+#define SAVE_INDEX_MAGIC "AYBI"
+#define SAVE_INDEX_VERSION 1
+#define SAVE_INDEX_HEADER_SIZE 16
+#define SAVE_INDEX_RECORD_SIZE 64
+#define SAVE_INDEX_NAME_LENGTH 40
+// Longest save name: it must fit an index record with its terminator
+#define SAVE_NAME_MAX (SAVE_INDEX_NAME_LENGTH - 1)
+// Save file name buffer, "save_<name>.dat"
+#define SAVE_FILE_LENGTH (sizeof("save_.dat") + SAVE_NAME_MAX)
+// Width of one save in the info area: name, then rooms/kills
+#define SAVE_LIST_NAME_WIDTH 14
+#define SAVE_LIST_CELL_WIDTH 24
+// Saves that can be queued or waiting to be reported at once
+#define SAVE_QUEUE_SIZE 8
+
+typedef struct SaveIndexEntry {
+    char name[SAVE_INDEX_NAME_LENGTH];
+    uint32_t size;
+    int64_t mtime;
+    uint32_t rooms_walked;
+    uint32_t mobs_killed;
+} SaveIndexEntry;
+
+// A save handed to the writer thread, the game state is copied by value.
+// player.world, rooms and paths are cleared: the world map is live game
+// state, world is an image of it owned by the job and freed on the game
+// thread once the save is reported.
+typedef struct SaveJob {
+    char file[SAVE_FILE_LENGTH];
+    Player player;
+    Room room;
+    WorldImage world;
+    bool ok;
+    int error;
+} SaveJob;
+
+#ifndef _WIN32
+// The writer thread patches the index while `list` may be reading it
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void save_index_lock() {
+#ifndef _WIN32
+    pthread_mutex_lock(&index_mutex);
+#endif
 }
 
+static void save_index_unlock() {
+#ifndef _WIN32
+    pthread_mutex_unlock(&index_mutex);
+#endif
+}
+
+// Read-only view of the index file, mmapped where available
+typedef struct SaveIndexView {
+    unsigned char *data;
+    size_t size;
+    uint32_t count;
+} SaveIndexView;
+
+static void save_index_encode(unsigned char *record, SaveIndexEntry *e) {
+    SaveBuffer b = { record, SAVE_INDEX_RECORD_SIZE, 0, true };
+    memcpy(save_take(&b, SAVE_INDEX_NAME_LENGTH), e->name, SAVE_INDEX_NAME_LENGTH);
+    put_uint(&b, e->size, 4);
+    put_uint(&b, (uint64_t)e->mtime, 8);
+    put_uint(&b, e->rooms_walked, 4);
+    put_uint(&b, e->mobs_killed, 4);
+    put_uint(&b, 0, 4);
+}
+
+static void save_index_decode(unsigned char *record, SaveIndexEntry *e) {
+    SaveBuffer b = { record, SAVE_INDEX_RECORD_SIZE, 0, true };
+    memcpy(e->name, save_take(&b, SAVE_INDEX_NAME_LENGTH), SAVE_INDEX_NAME_LENGTH);
+    e->name[SAVE_INDEX_NAME_LENGTH - 1] = '\0';
+    e->size = (uint32_t)get_uint(&b, 4);
+    e->mtime = (int64_t)get_uint(&b, 8);
+    e->rooms_walked = (uint32_t)get_uint(&b, 4);
+    e->mobs_killed = (uint32_t)get_uint(&b, 4);
+}
+
+static void save_index_header(unsigned char *header, uint32_t count) {
+    SaveBuffer b = { header, SAVE_INDEX_HEADER_SIZE, 0, true };
+    memcpy(save_take(&b, 4), SAVE_INDEX_MAGIC, 4);
+    put_uint(&b, SAVE_INDEX_VERSION, 2);
+    put_uint(&b, SAVE_INDEX_RECORD_SIZE, 2);
+    put_uint(&b, count, 4);
+    put_uint(&b, 0, 4);
+}
+
+static void save_index_close(SaveIndexView *view) {
+    if (view->data == NULL) {
+        return;
+    }
 #ifdef _WIN32
-    #include <windows.h>
+    free(view->data);
 #else
-    #include <dirent.h>
+    munmap(view->data, view->size);
 #endif
+    memset(view, 0, sizeof(*view));
+}
 
-void list_saves() {
-    printf("Saved games: ");
+/* @
+ * save_index_open: bool
+ * ----------------------
+ * Maps the index file read-only (one mmap, or one read on Windows) and checks its header.
+ *
+ * Parameters:
+ * - view: SaveIndexView* - Receives the mapping, release it with save_index_close.
+ *
+ * Returns:
+ * - true if the index exists and is valid.
+ */
+static bool save_index_open(SaveIndexView *view) {
+    memset(view, 0, sizeof(*view));
+#ifdef _WIN32
+    FILE *file = fopen(SAVE_INDEX_FILE, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < SAVE_INDEX_HEADER_SIZE || (view->data = malloc((size_t)size)) == NULL) {
+        fclose(file);
+        return false;
+    }
+    view->size = fread(view->data, 1, (size_t)size, file);
+    fclose(file);
+#else
+    int fd = open(SAVE_INDEX_FILE, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SAVE_INDEX_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    view->data = data;
+    view->size = (size_t)st.st_size;
+#endif
+    SaveBuffer b = { view->data, view->size, 0, true };
+    bool ok = memcmp(save_take(&b, 4), SAVE_INDEX_MAGIC, 4) == 0
+        && get_uint(&b, 2) == SAVE_INDEX_VERSION
+        && get_uint(&b, 2) == SAVE_INDEX_RECORD_SIZE;
+    view->count = (uint32_t)get_uint(&b, 4);
+    if (!ok || view->count > (view->size - SAVE_INDEX_HEADER_SIZE) / SAVE_INDEX_RECORD_SIZE) {
+        save_index_close(view);
+        return false;
+    }
+    return true;
+}
+
+static unsigned char *save_index_record(SaveIndexView *view, uint32_t i) {
+    return view->data + SAVE_INDEX_HEADER_SIZE + (size_t)i * SAVE_INDEX_RECORD_SIZE;
+}
+
+/* @
+ * save_index_rebuild: bool
+ * -------------------------
+ * Recreates the index from the save files in the working directory. Only
+ * needed when the index is missing or broken, e.g. for saves made before it existed.
+ *
+ * Returns:
+ * - true if the index was written.
+ */
+static bool save_index_rebuild() {
+    FILE *index = fopen(SAVE_INDEX_FILE ".tmp", "wb");
+    if (index == NULL) {
+        return false;
+    }
+    unsigned char header[SAVE_INDEX_HEADER_SIZE];
+    save_index_header(header, 0);
+    fwrite(header, 1, sizeof(header), index);
 
+    uint32_t count = 0;
+    unsigned char record[SAVE_INDEX_RECORD_SIZE];
+    Player p;
+    Room r;
+    WorldImage world;
 #ifdef _WIN32
     WIN32_FIND_DATA findFileData;
     HANDLE hFind = FindFirstFile("save_*.dat", &findFileData);
+    bool found = hFind != INVALID_HANDLE_VALUE;
+    while (found) {
+        const char *file_name = findFileData.cFileName;
+#else
+    DIR *dp = opendir("./");
+    if (dp == NULL) {
+        fclose(index);
+        return false;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dp))) {
+        const char *file_name = entry->d_name;
+#endif
+        size_t length = strlen(file_name);
+        if (strncmp(file_name, "save_", 5) == 0 && length > 9 && strcmp(file_name + length - 4, ".dat") == 0) {
+            size_t size = 0;
+            unsigned char *data = save_read_file(file_name, &size);
+            bool valid = data != NULL && save_decode(data, size, &p, &r, &world);
+            free(data);
+            if (valid) {
+                world_image_free(&world);
+            }
+            struct stat st;
+            if (valid && stat(file_name, &st) == 0) {
+                SaveIndexEntry e;
+                memset(&e, 0, sizeof(e));
+                snprintf(e.name, sizeof(e.name), "%.*s", (int)(length - 9), file_name + 5);
+                e.size = (uint32_t)size;
+                e.mtime = (int64_t)st.st_mtime;
+                e.rooms_walked = (uint32_t)p.rooms_walked;
+                e.mobs_killed = (uint32_t)p.mobs_killed;
+                save_index_encode(record, &e);
+                fwrite(record, 1, sizeof(record), index);
+                count++;
+            }
+        }
+#ifdef _WIN32
+        found = FindNextFile(hFind, &findFileData) != 0;
+    }
+    if (hFind != INVALID_HANDLE_VALUE) {
+        FindClose(hFind);
+    }
+#else
+    }
+    closedir(dp);
+#endif
+    save_index_header(header, count);
+    fseek(index, 0, SEEK_SET);
+    bool ok = fwrite(header, 1, sizeof(header), index) == sizeof(header);
+    ok = fclose(index) == 0 && ok;
+    return ok && rename(SAVE_INDEX_FILE ".tmp", SAVE_INDEX_FILE) == 0;
+}
 
-    if (hFind == INVALID_HANDLE_VALUE) {
-        printf("No saved games.");
+/* @
+ * save_index_update: void
+ * ------------------------
+ * Adds or replaces the index record of a save that was just written. The
+ * record is patched in place, so the cost doesn't grow with the file size.
+ *
+ * Parameters:
+ * - e: SaveIndexEntry* - Summary of the save.
+ */
+static void save_index_update(SaveIndexEntry *e) {
+    SaveIndexView view;
+    if (!save_index_open(&view)) {
+        // the rebuild picks up the save that was just written
+        save_index_rebuild();
         return;
     }
+    uint32_t slot = view.count;
+    for (uint32_t i = 0; i < view.count; i++) {
+        if (strncmp((char *)save_index_record(&view, i), e->name, SAVE_INDEX_NAME_LENGTH) == 0) {
+            slot = i;
+            break;
+        }
+    }
+    uint32_t count = view.count;
+    save_index_close(&view);
 
-    do {
-        printf("%s ", findFileData.cFileName);
-    } while (FindNextFile(hFind, &findFileData) != 0);
+    FILE *index = fopen(SAVE_INDEX_FILE, "r+b");
+    if (index == NULL) {
+        return;
+    }
+    unsigned char record[SAVE_INDEX_RECORD_SIZE];
+    save_index_encode(record, e);
+    fseek(index, SAVE_INDEX_HEADER_SIZE + (long)slot * SAVE_INDEX_RECORD_SIZE, SEEK_SET);
+    fwrite(record, 1, sizeof(record), index);
+    if (slot == count) {
+        unsigned char header[SAVE_INDEX_HEADER_SIZE];
+        save_index_header(header, count + 1);
+        fseek(index, 0, SEEK_SET);
+        fwrite(header, 1, sizeof(header), index);
+    }
+    fclose(index);
+}
 
-    FindClose(hFind);
+/* @
+ * save_restore: bool
+ * -------------------
+ * Replaces the game state with an encoded save. The buffer is fully decoded
+ * into temporaries first, so the current game stays intact on errors.
+ *
+ * Parameters:
+ * - player: Player* - Game state to replace, its room pool is kept.
+ * - data: unsigned char* - Encoded save, as written by save_encode.
+ * - size: size_t - Number of bytes in data.
+ *
+ * Returns:
+ * - true if the save was valid and has been restored.
+ */
+bool save_restore(Player *player, unsigned char *data, size_t size) {
+    Player loaded;
+    Room room;
+    WorldImage world;
+    if (!save_decode(data, size, &loaded, &room, &world)) {
+        return false;
+    }
+    // the map goes first, it is the only part that can still fail
+    if (world.map && !world_import(player->world, &world)) {
+        world_image_free(&world);
+        return false;
+    }
 
-#else
-    struct dirent *entry;
-    DIR *dp = opendir("./");
+    // move the loaded room into the session's room pool
+    Room *r = room_pool_acquire(player->rooms);
+    *r = room;
+    room_pool_release(player->rooms, player->room);
+    loaded.rooms = player->rooms;
+    loaded.room = r;
+    loaded.world = player->world;
+    loaded.paths = player->paths;
+    *player = loaded;
+    if (!world.map) {
+        // older saves have no map, their room is the only one the map knows
+        world_reset(player->world, world.procedural, &player->rng);
+        world_adopt(player->world, player->x, player->y, player->room_index, r, (uint32_t)player->rooms_walked);
+    }
+    world_image_free(&world);
+    return true;
+}
 
-    if (dp == NULL) {
-        perror("Could not open directory!");
+/* @
+ * save_write: bool
+ * -----------------
+ * Encodes a save job into a temporary file (reading the spilled chunks of its
+ * map as it goes), renames it into place and records it in the save index.
+ * Runs on the writer thread.
+ *
+ * Parameters:
+ * - job: SaveJob* - Game state copied by save_player.
+ *
+ * Returns:
+ * - true if the save is on disk, otherwise job->error tells why.
+ */
+static bool save_write(SaveJob *job) {
+    job->player.room = &job->room;
+    char temp[sizeof(job->file) + 4];
+    snprintf(temp, sizeof(temp), "%s.tmp", job->file);
+    FILE *file = fopen(temp, "wb");
+    if (file == NULL) {
+        job->error = errno;
+        return false;
+    }
+    size_t size = save_encode_file(&job->player, &job->world, file);
+    job->error = errno;
+    if (fclose(file) != 0 && size > 0) {
+        job->error = errno;
+        size = 0;
+    }
+    if (size == 0) {
+        remove(temp);
+        return false;
+    }
+#ifdef _WIN32
+    // rename doesn't replace existing files on Windows
+    remove(job->file);
+#endif
+    if (rename(temp, job->file) != 0) {
+        job->error = errno;
+        remove(temp);
+        return false;
+    }
+
+    SaveIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    snprintf(entry.name, sizeof(entry.name), "%.*s", (int)strlen(job->file) - 9, job->file + 5);
+    entry.size = (uint32_t)size;
+    entry.mtime = (int64_t)time(NULL);
+    entry.rooms_walked = (uint32_t)job->player.rooms_walked;
+    entry.mobs_killed = (uint32_t)job->player.mobs_killed;
+    save_index_lock();
+    save_index_update(&entry);
+    save_index_unlock();
+    return true;
+}
+
+/* @
+ * save_report: void
+ * ------------------
+ * Shows the outcome of a finished save on the output line.
+ */
+static void save_report(SaveJob *job) {
+    if (job->ok) {
+        draw_output_text("Game successfully saved to: '%s'!", job->file);
+    } else {
+        draw_output_text("The game could not be saved to '%s': %s", job->file, strerror(job->error));
+    }
+}
+
+#ifndef _WIN32
+// Saves waiting for the writer thread, and finished saves waiting to be
+// reported. in_flight counts both, so neither ring can overflow.
+static SaveJob save_queue[SAVE_QUEUE_SIZE];
+static SaveJob save_done[SAVE_QUEUE_SIZE];
+static int queue_head = 0, queue_count = 0;
+static int done_head = 0, done_count = 0;
+static int in_flight = 0;
+static bool writer_started = false;
+static bool writer_stopping = false;
+static pthread_t writer_thread;
+static pthread_t input_thread;
+static pthread_mutex_t save_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t save_cond = PTHREAD_COND_INITIALIZER;
+
+// Only wakes up the read of the next command, see save_take_done
+static void handle_save_done(int sig) {
+    (void)sig;
+}
+
+/* @
+ * save_writer: void*
+ * -------------------
+ * Writer thread: takes jobs off the queue and writes them one by one. The
+ * mutex is never held during file IO, so a slow disk only delays the report.
+ */
+static void *save_writer(void *arg) {
+    (void)arg;
+    SaveJob job;
+    while (1) {
+        pthread_mutex_lock(&save_mutex);
+        while (queue_count == 0 && !writer_stopping) {
+            pthread_cond_wait(&save_cond, &save_mutex);
+        }
+        if (queue_count == 0) {
+            pthread_mutex_unlock(&save_mutex);
+            return NULL;
+        }
+        job = save_queue[queue_head];
+        queue_head = (queue_head + 1) % SAVE_QUEUE_SIZE;
+        queue_count--;
+        pthread_mutex_unlock(&save_mutex);
+
+        job.ok = save_write(&job);
+
+        pthread_mutex_lock(&save_mutex);
+        save_done[(done_head + done_count) % SAVE_QUEUE_SIZE] = job;
+        done_count++;
+        pthread_mutex_unlock(&save_mutex);
+        // interrupt the blocking read so the result shows up right away
+        pthread_kill(input_thread, SIGUSR1);
+    }
+}
+
+/* @
+ * save_start_writer: bool
+ * ------------------------
+ * Starts the writer thread on the first save. The thread blocks every
+ * signal, so resizes and hangups keep going to the thread reading input.
+ */
+static bool save_start_writer() {
+    if (writer_started) {
+        return true;
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_save_done;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    input_thread = pthread_self();
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    writer_started = pthread_create(&writer_thread, NULL, save_writer, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return writer_started;
+}
+#endif
+
+/* @
+ * save_player: void
+ * ------------------
+ * Queues the game for saving and returns at once. The player, the room and
+ * the world map's chunks in memory are copied here on the game thread, the
+ * writer thread reads the spilled chunks, encodes and writes the save, and
+ * the result is reported by save_take_done.
+ *
+ * Parameters:
+ * - player: Player* - Game state to save.
+ * - filename: char* - Save name, the file is save_<filename>.dat. Names longer
+ *   than SAVE_NAME_MAX are refused, they would not fit the index.
+ *
+ * Notes:
+ * - Without pthreads (Windows) the save is written right away.
+ */
+void save_player(Player *player, char *filename) {
+    if (player->room == NULL) {
+        draw_output_text("There is no game to save!");
+        return;
+    }
+    if (strlen(filename) > SAVE_NAME_MAX) {
+        draw_output_text("The save name is too long, at most %d characters!", SAVE_NAME_MAX);
+        return;
+    }
+    SaveJob job;
+    memset(&job, 0, sizeof(job));
+    snprintf(job.file, sizeof(job.file), "save_%s.dat", filename);
+    job.player = *player;
+    job.player.world = NULL;
+    job.player.rooms = NULL;
+    job.player.paths = NULL;
+    job.room = *player->room;
+    if (!world_export(player->world, &job.world)) {
+        draw_output_text("Not enough memory to save the game!");
         return;
     }
 
-    while ((entry = readdir(dp))) {
-        if (strncmp(entry->d_name, "save_", 5) == 0 && strstr(entry->d_name, ".dat")) {
-            printf("%s\n", entry->d_name);
+#ifdef _WIN32
+    job.ok = save_write(&job);
+    world_image_free(&job.world);
+    save_report(&job);
+#else
+    pthread_mutex_lock(&save_mutex);
+    bool queued = in_flight < SAVE_QUEUE_SIZE && save_start_writer();
+    if (queued) {
+        save_queue[(queue_head + queue_count) % SAVE_QUEUE_SIZE] = job;
+        queue_count++;
+        in_flight++;
+        pthread_cond_signal(&save_cond);
+    }
+    pthread_mutex_unlock(&save_mutex);
+    if (queued) {
+        draw_output_text("Saving to '%s'...", job.file);
+    } else {
+        world_image_free(&job.world);
+        draw_output_text("Too many saves in progress, try again in a moment!");
+    }
+#endif
+}
+
+/* @
+ * save_take_done: bool
+ * ---------------------
+ * Reports saves the writer thread finished since the last call.
+ *
+ * Returns:
+ * - true if anything was reported (the screen changed).
+ */
+bool save_take_done() {
+#ifdef _WIN32
+    return false;
+#else
+    bool reported = false;
+    while (1) {
+        pthread_mutex_lock(&save_mutex);
+        if (done_count == 0) {
+            pthread_mutex_unlock(&save_mutex);
+            return reported;
         }
+        SaveJob job = save_done[done_head];
+        done_head = (done_head + 1) % SAVE_QUEUE_SIZE;
+        done_count--;
+        in_flight--;
+        pthread_mutex_unlock(&save_mutex);
+        world_image_free(&job.world);
+        save_report(&job);
+        reported = true;
     }
-    closedir(dp);
 #endif
-}
\ No newline at end of file
+}
+
+/* @
+ * save_shutdown: void
+ * --------------------
+ * Waits until every queued save is written and stops the writer thread.
+ * Called before the game quits.
+ */
+void save_shutdown() {
+#ifndef _WIN32
+    if (!writer_started) {
+        return;
+    }
+    pthread_mutex_lock(&save_mutex);
+    writer_stopping = true;
+    pthread_cond_broadcast(&save_cond);
+    pthread_mutex_unlock(&save_mutex);
+    pthread_join(writer_thread, NULL);
+    writer_started = false;
+    writer_stopping = false;
+#endif
+}
+
+bool load_player(Player *player, char *filename) {
+    if (strlen(filename) > SAVE_NAME_MAX) {
+        draw_output_text("The save name is too long, at most %d characters!", SAVE_NAME_MAX);
+        return false;
+    }
+    char f[SAVE_FILE_LENGTH];
+    snprintf(f, sizeof(f), "save_%s.dat", filename);
+    size_t size = 0;
+    unsigned char *data = save_read_file(f, &size);
+    if (data == NULL) {
+        draw_output_text("The file can not be opened: %s", strerror(errno));
+        return false;
+    }
+
+    bool restored = save_restore(player, data, size);
+    free(data);
+    if (!restored) {
+        draw_output_text("The save file '%s' is broken!", f);
+        return false;
+    }
+
+    screen_print("The game loaded from '%s'!", f);
+    return true;
+}
+
+static int save_sort_name(const void *a, const void *b) {
+    return strcasecmp(((const SaveIndexEntry *)a)->name, ((const SaveIndexEntry *)b)->name);
+}
+static int save_sort_date(const void *a, const void *b) {
+    int64_t x = ((const SaveIndexEntry *)a)->mtime, y = ((const SaveIndexEntry *)b)->mtime;
+    return (x < y) - (x > y); // newest first
+}
+static int save_sort_size(const void *a, const void *b) {
+    uint32_t x = ((const SaveIndexEntry *)a)->size, y = ((const SaveIndexEntry *)b)->size;
+    return (x < y) - (x > y);
+}
+static int save_sort_rooms(const void *a, const void *b) {
+    uint32_t x = ((const SaveIndexEntry *)a)->rooms_walked, y = ((const SaveIndexEntry *)b)->rooms_walked;
+    return (x < y) - (x > y);
+}
+static int save_sort_kills(const void *a, const void *b) {
+    uint32_t x = ((const SaveIndexEntry *)a)->mobs_killed, y = ((const SaveIndexEntry *)b)->mobs_killed;
+    return (x < y) - (x > y);
+}
+
+static const struct {
+    const char *name;
+    int (*compare)(const void *, const void *);
+} save_sorts[] = {
+    { "date", save_sort_date },
+    { "name", save_sort_name },
+    { "size", save_sort_size },
+    { "rooms", save_sort_rooms },
+    { "kills", save_sort_kills }
+};
+
+/* @
+ * list_saves: void
+ * -----------------
+ * Shows one page of saved games in the info area, read from the save index.
+ *
+ * Parameters:
+ * - arg: char* - Optional "[page] [date|name|size|rooms|kills]", default is page 1 by date.
+ */
+void list_saves(char *arg) {
+    int page = 1;
+    size_t sort = 0;
+    char key[16] = "";
+    if (sscanf(arg, "%d %15s", &page, key) < 1) {
+        sscanf(arg, "%15s", key);
+    }
+    if (key[0] != '\0') {
+        size_t i = 0;
+        while (i < sizeof(save_sorts) / sizeof(save_sorts[0]) && strcasecmp(save_sorts[i].name, key) != 0) {
+            i++;
+        }
+        if (i == sizeof(save_sorts) / sizeof(save_sorts[0])) {
+            draw_output_text("Usage: list [page] [date|name|size|rooms|kills]");
+            return;
+        }
+        sort = i;
+    }
+
+    SaveIndexView view;
+    save_index_lock();
+    if (!save_index_open(&view) && !(save_index_rebuild() && save_index_open(&view))) {
+        save_index_unlock();
+        draw_output_text("No saved games.");
+        return;
+    }
+    uint32_t count = view.count;
+    SaveIndexEntry *entries = count > 0 ? malloc(count * sizeof(SaveIndexEntry)) : NULL;
+    if (count > 0 && entries == NULL) {
+        save_index_close(&view);
+        save_index_unlock();
+        draw_output_text("Not enough memory to list saves!");
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        save_index_decode(save_index_record(&view, i), &entries[i]);
+    }
+    save_index_close(&view);
+    save_index_unlock();
+    if (count == 0) {
+        draw_output_text("No saved games.");
+        return;
+    }
+    qsort(entries, count, sizeof(SaveIndexEntry), save_sorts[sort].compare);
+
+    // two info lines of fixed-width cells
+    int per_line = get_info_width() / SAVE_LIST_CELL_WIDTH;
+    if (per_line < 1) {
+        per_line = 1;
+    }
+    int per_page = per_line * 2;
+    int pages = ((int)count + per_page - 1) / per_page;
+    if (page < 1 || page > pages) {
+        free(entries);
+        draw_output_text("No page %d, there are %d pages of saves.", page, pages);
+        return;
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "> SAVES %d/%d BY %s (ROOMS/KILLS) <", page, pages, save_sorts[sort].name);
+    for (char *c = title; *c; c++) {
+        *c = (char)toupper((unsigned char)*c);
+    }
+    change_info_title(title);
+    clear_info_1();
+    clear_info_2();
+    for (int line = 0; line < 2; line++) {
+        if (line == 0) {
+            move_cursor_info_1();
+        } else {
+            move_cursor_info_2();
+        }
+        for (int col = 0; col < per_line; col++) {
+            int i = (page - 1) * per_page + line * per_line + col;
+            if (i >= (int)count) {
+                break;
+            }
+            char stats[16];
+            snprintf(stats, sizeof(stats), "%u/%u", entries[i].rooms_walked, entries[i].mobs_killed);
+            screen_print("%-*.*s %-*s", SAVE_LIST_NAME_WIDTH, SAVE_LIST_NAME_WIDTH, entries[i].name,
+                SAVE_LIST_CELL_WIDTH - SAVE_LIST_NAME_WIDTH - 1, stats);
+        }
+    }
+    free(entries);
+    draw_output_text("%u saves. Usage: list [page] [date|name|size|rooms|kills]", count);
+}
@@ -3,51 +3,588 @@
 // Declaring width and height here to update dynamically.
 int WIDTH, HEIGHT;
 
+// Where finished frames go. Set once at startup, before get_terminal_size.
+static const RenderBackend *backend = &render_backend_ansi;
+
+/*
+Frame buffers, one char per terminal cell (WIDTH x (HEIGHT + 1)).
+Drawing functions only write into frame_back; screen_flush compares it with
+frame_front (what the terminal currently shows) and sends the changed cells.
+A '\0' cell in frame_front means "unknown", so it is always resent.
+*/
+static char *frame_back = NULL;
+static char *frame_front = NULL;
+static int frame_cols = 0;
+static int frame_rows = 0;
+static bool frame_clear_pending = false;
+
+// Virtual cursor, where the next screen_print writes into frame_back.
+static int cursor_x = 0;
+static int cursor_y = 0;
+
+// Growable output buffer. screen_flush composes a whole update here and
+// hands it to the terminal with a single write.
+static char *out_buf = NULL;
+static size_t out_len = 0;
+static size_t out_cap = 0;
+
+/*
+out_append : void
+args:
+- data : const char *
+- len : size_t
+Appends raw bytes to the output buffer, growing it when needed.
+*/
+static void out_append(const char *data, size_t len)
+{
+    if (out_len + len > out_cap)
+    {
+        size_t cap = out_cap ? out_cap : 4096;
+        while (cap < out_len + len)
+        {
+            cap *= 2;
+        }
+        char *grown = (char *)realloc(out_buf, cap);
+        if (grown == NULL)
+        {
+            return;
+        }
+        out_buf = grown;
+        out_cap = cap;
+    }
+    memcpy(out_buf + out_len, data, len);
+    out_len += len;
+}
+
+// Where the real terminal cursor is after the bytes sent so far, -1 if unknown
+// (after the user typed a command, or after writing into the last column).
+static int term_x = -1;
+static int term_y = -1;
+
+// Blank stretches at least this long are erased with ECH instead of spaces.
+#define ERASE_MIN_RUN 8
+
+/*
+out_move : void
+args:
+- x : int
+- y : int
+- back : const char * - back buffer row y, for rewriting cells as a motion
+- front : const char * - front buffer row y
+Moves the terminal cursor to x, y with the shortest sequence: nothing, CR,
+relative CUU/CUD/CUF/CUB, re-sending up to a few unchanged cells, or an
+absolute CUP.
+*/
+static void out_move(int x, int y, const char *back, const char *front)
+{
+    if (x == term_x && y == term_y)
+    {
+        return;
+    }
+    char best[32];
+    int best_len = (x == 0) ? snprintf(best, sizeof(best), "\033[%dH", y + 1)
+                            : snprintf(best, sizeof(best), "\033[%d;%dH", y + 1, x + 1);
+    if (x == 0 && y == 0)
+    {
+        best_len = snprintf(best, sizeof(best), "\033[H");
+    }
+    if (term_x >= 0 && term_y >= 0)
+    {
+        char rel[32];
+        int len = 0;
+        int dy = y - term_y;
+        int dx = x - term_x;
+        if (dy != 0)
+        {
+            int n = dy > 0 ? dy : -dy;
+            len += (n == 1) ? snprintf(rel + len, sizeof(rel) - len, "\033[%c", dy > 0 ? 'B' : 'A')
+                            : snprintf(rel + len, sizeof(rel) - len, "\033[%d%c", n, dy > 0 ? 'B' : 'A');
+        }
+        if (dx != 0 && x == 0)
+        {
+            rel[len++] = '\r';
+        }
+        else if (dx != 0)
+        {
+            int n = dx > 0 ? dx : -dx;
+            len += (n == 1) ? snprintf(rel + len, sizeof(rel) - len, "\033[%c", dx > 0 ? 'C' : 'D')
+                            : snprintf(rel + len, sizeof(rel) - len, "\033[%d%c", n, dx > 0 ? 'C' : 'D');
+        }
+        if (len < best_len)
+        {
+            memcpy(best, rel, len);
+            best_len = len;
+        }
+        // Moving right over cells the terminal already shows correctly:
+        // sending them again is often shorter than any escape sequence.
+        if (dy == 0 && dx > 0 && dx < best_len && back != NULL)
+        {
+            bool same = true;
+            for (int i = term_x; i < x && same; i++)
+            {
+                same = front[i] != '\0' && front[i] == back[i];
+            }
+            if (same)
+            {
+                memcpy(best, back + term_x, dx);
+                best_len = dx;
+            }
+        }
+    }
+    out_append(best, best_len);
+    term_x = x;
+    term_y = y;
+}
+
+/*
+out_cells : void
+args:
+- x : int - column the terminal cursor is at
+- cells : const char *
+- len : int
+Writes cells at the cursor and keeps term_x in sync. Writing into the last
+column leaves the terminal in its pending-wrap state, so the position is
+unknown afterwards.
+*/
+static void out_cells(int x, const char *cells, int len)
+{
+    out_append(cells, len);
+    term_x = x + len;
+    if (term_x >= frame_cols)
+    {
+        term_x = -1;
+        term_y = -1;
+    }
+}
+
+/*
+out_send : void
+Hands the whole output buffer to the backend in one call and empties it.
+*/
+static void out_send()
+{
+    if (out_len == 0)
+    {
+        return;
+    }
+    backend->write(out_buf, out_len);
+    out_len = 0;
+}
+
+/*
+Prebuilt screen templates, rebuilt whenever the terminal size changes.
+- border_frame: a whole empty screen with the outer border and the separator line.
+- room_frames: the room area (walls, doors, player) for each of the 16 door masks.
+*/
+static char *border_frame = NULL;
+static char *room_frames = NULL;
+static int room_area_x = 0;
+static int room_area_y = 0;
+static int room_area_w = 0;
+static int room_area_h = 0;
+
+/*
+Screen positions derived from WIDTH and HEIGHT, recomputed on every relayout
+so the drawing functions don't redo the arithmetic on each call.
+*/
+static struct
+{
+    int title_y;     // separator line that holds the info title
+    int info_1_y;
+    int info_2_y;
+    int stats_y;
+    int input_y;     // "COMMAND: " prompt row
+    int output_y;
+    int line_end_x;  // first column of the right border area
+    int guard_n_y;   // north guard row
+    int guard_s_y;   // south guard row
+    int guard_we_y;  // west and east guard row
+    int guard_w_x;
+    int guard_e_x;
+} layout;
+
+// Set from the SIGWINCH handler, consumed by screen_take_resize.
+static volatile sig_atomic_t resize_pending = 0;
+
+static void draw_border_lines();
+
+/*
+layout_compute : void
+Fills the layout cache from the current WIDTH and HEIGHT.
+*/
+static void layout_compute()
+{
+    layout.title_y = HEIGHT - ROOM_OFFSET_S + 1;
+    layout.info_1_y = HEIGHT - CMD_OUTPUT_OFFSET_S - 4;
+    layout.info_2_y = HEIGHT - CMD_OUTPUT_OFFSET_S - 3;
+    layout.stats_y = HEIGHT - CMD_OFFSET_S - 1;
+    layout.input_y = HEIGHT - CMD_STRING_OFFSET_S;
+    layout.output_y = HEIGHT - CMD_OUTPUT_OFFSET_S;
+    layout.line_end_x = WIDTH - ROOM_OFFSET_E;
+    layout.guard_n_y = ROOM_OFFSET_N + 3;
+    layout.guard_s_y = HEIGHT - (ROOM_OFFSET_S + 3);
+    layout.guard_we_y = (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N;
+    layout.guard_w_x = ROOM_OFFSET_W + 3;
+    layout.guard_e_x = WIDTH - ROOM_OFFSET_E - 15;
+}
+
+/*
+frame_build_templates : void
+Renders the border and all 16 room frames once with the regular drawing
+functions, so every later draw is a plain copy of ready-made cells.
+*/
+static void frame_build_templates()
+{
+    size_t frame_size = (size_t)frame_cols * frame_rows;
+    char *target = frame_back;
+
+    room_area_x = ROOM_OFFSET_W;
+    room_area_y = ROOM_OFFSET_N;
+    room_area_w = WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W;
+    room_area_h = HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N + 1;
+    if (room_area_w < 0 || room_area_x + room_area_w > frame_cols)
+    {
+        room_area_w = 0;
+    }
+    if (room_area_h < 0 || room_area_y + room_area_h > frame_rows)
+    {
+        room_area_h = 0;
+    }
+
+    free(border_frame);
+    free(room_frames);
+    border_frame = (char *)malloc(frame_size);
+    room_frames = (char *)malloc((size_t)16 * room_area_w * room_area_h + 1);
+
+    frame_back = border_frame;
+    memset(frame_back, ' ', frame_size);
+    draw_border_lines();
+
+    char *scratch = (char *)malloc(frame_size);
+    frame_back = scratch;
+    for (int doors = 0; doors < 16; doors++)
+    {
+        memset(frame_back, ' ', frame_size);
+        game_print_north_wall((doors & 0b1000) >> 3);
+        game_print_east_wall((doors & 0b0100) >> 2);
+        game_print_south_wall((doors & 0b0010) >> 1);
+        game_print_west_wall((doors & 0b0001));
+        draw_player();
+        char *room = room_frames + (size_t)doors * room_area_w * room_area_h;
+        for (int i = 0; i < room_area_h; i++)
+        {
+            memcpy(room + (size_t)i * room_area_w, scratch + (size_t)(room_area_y + i) * frame_cols + room_area_x, room_area_w);
+        }
+    }
+    free(scratch);
+    frame_back = target;
+}
+
+/*
+frame_resize : void
+(Re)allocates both frame buffers for the current WIDTH and HEIGHT.
+The front buffer starts unknown, so the next flush repaints everything.
+*/
+static void frame_resize()
+{
+    int cols = WIDTH > 0 ? WIDTH : 1;
+    int rows = HEIGHT >= 0 ? HEIGHT + 1 : 1;
+    if (cols != frame_cols || rows != frame_rows || frame_back == NULL)
+    {
+        free(frame_back);
+        free(frame_front);
+        frame_back = (char *)malloc((size_t)cols * rows);
+        frame_front = (char *)malloc((size_t)cols * rows);
+        frame_cols = cols;
+        frame_rows = rows;
+    }
+    layout_compute();
+    frame_build_templates();
+    memset(frame_back, ' ', (size_t)frame_cols * frame_rows);
+    memset(frame_front, 0, (size_t)frame_cols * frame_rows);
+    cursor_x = 0;
+    cursor_y = 0;
+}
+
+/*
+frame_write : void
+args:
+- text : const char *
+- len : size_t
+Writes text into the back buffer at the virtual cursor and advances it.
+Text is clipped at the right edge and stops at a newline.
+*/
+static void frame_write(const char *text, size_t len)
+{
+    if (!backend->draws)
+    {
+        return;
+    }
+    char *row = frame_back + (size_t)cursor_y * frame_cols;
+    for (size_t i = 0; i < len && text[i] != '\n' && cursor_x < frame_cols; i++)
+    {
+        row[cursor_x++] = text[i];
+    }
+}
+
+/*
+frame_fill : void
+args:
+- c : char
+- count : int
+Writes count copies of c at the virtual cursor, clipped at the right edge.
+*/
+static void frame_fill(char c, int count)
+{
+    if (!backend->draws)
+    {
+        return;
+    }
+    if (count > frame_cols - cursor_x)
+    {
+        count = frame_cols - cursor_x;
+    }
+    if (count <= 0)
+    {
+        return;
+    }
+    memset(frame_back + (size_t)cursor_y * frame_cols + cursor_x, c, count);
+    cursor_x += count;
+}
+
+/*
+screen_print : void
+args:
+- format : const char *
+Formatted print into the back buffer at the virtual cursor. Replaces printf
+for everything that ends up on the game screen.
+*/
+void screen_print(const char *format, ...)
+{
+    if (!backend->draws)
+    {
+        return;
+    }
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len < 0)
+    {
+        return;
+    }
+    if ((size_t)len >= sizeof(line))
+    {
+        len = sizeof(line) - 1;
+    }
+    frame_write(line, len);
+}
+
+/*
+screen_flush : void
+Sends the cells that differ between the back and the front buffer, then
+places the terminal cursor at the virtual cursor. Cursor jumps use the
+shortest motion available (see out_move). Changed blank stretches are erased
+with EL when they reach the end of the row, or with ECH when something
+follows them (like the right border), instead of being sent as spaces.
+The whole update leaves the process as one write call.
+*/
+void screen_flush()
+{
+    if (!backend->draws || frame_back == NULL)
+    {
+        return;
+    }
+    if (frame_clear_pending)
+    {
+        out_append("\033[2J\033[H", 7);
+        memset(frame_front, ' ', (size_t)frame_cols * frame_rows);
+        frame_clear_pending = false;
+        term_x = 0;
+        term_y = 0;
+    }
+    for (int y = 0; y < frame_rows; y++)
+    {
+        char *back = frame_back + (size_t)y * frame_cols;
+        char *front = frame_front + (size_t)y * frame_cols;
+        if (memcmp(back, front, frame_cols) == 0)
+        {
+            continue;
+        }
+        // everything from blank_tail on is blank in the back buffer
+        int blank_tail = frame_cols;
+        while (blank_tail > 0 && back[blank_tail - 1] == ' ')
+        {
+            blank_tail--;
+        }
+        int x = 0;
+        while (x < frame_cols)
+        {
+            if (back[x] == front[x])
+            {
+                x++;
+                continue;
+            }
+            if (x >= blank_tail)
+            {
+                out_move(x, y, back, front);
+                out_append("\033[K", 3);
+                memset(front + x, ' ', frame_cols - x);
+                break;
+            }
+            int blanks = 0;
+            while (x + blanks < frame_cols && back[x + blanks] == ' ')
+            {
+                blanks++;
+            }
+            if (blanks >= ERASE_MIN_RUN)
+            {
+                char seq[16];
+                int len = snprintf(seq, sizeof(seq), "\033[%dX", blanks);
+                out_move(x, y, back, front);
+                out_append(seq, len);
+                memset(front + x, ' ', blanks);
+                x += blanks;
+                continue;
+            }
+            // a run of changed cells, stopping before a long blank stretch
+            int end = x + 1;
+            while (end < frame_cols && back[end] != front[end])
+            {
+                int ahead = 0;
+                while (end + ahead < frame_cols && back[end + ahead] == ' ' && ahead < ERASE_MIN_RUN)
+                {
+                    ahead++;
+                }
+                if (ahead >= ERASE_MIN_RUN)
+                {
+                    break;
+                }
+                end++;
+            }
+            out_move(x, y, back, front);
+            out_cells(x, back + x, end - x);
+            memcpy(front + x, back + x, end - x);
+            x = end;
+        }
+    }
+    out_move(cursor_x, cursor_y, NULL, NULL);
+    out_send();
+}
+
 /*
 clear_console : void
-Clears console by sendinjg special chars or commands.
+Clears the whole screen. The actual clear is sent by the next screen_flush.
 */
 void clear_console()
 {
-#ifdef _WIN32
-    system("cls");
-#else
-    printf("\033[2J");
-    printf("\033[H");
-#endif
+    if (!backend->draws)
+    {
+        return;
+    }
+    memset(frame_back, ' ', (size_t)frame_cols * frame_rows);
+    frame_clear_pending = true;
+}
+
+/*
+screen_set_backend : void
+args:
+- b : const RenderBackend *
+Chooses where frames are sent. Call it before get_terminal_size.
+*/
+void screen_set_backend(const RenderBackend *b)
+{
+    backend = b;
+}
+
+/*
+screen_get_backend : const RenderBackend *
+Returns the backend frames are currently sent to.
+*/
+const RenderBackend *screen_get_backend()
+{
+    return backend;
 }
 
 /*
 get_terminal_size : void
-Gets current terminal size from OS.
+Gets current terminal size from the backend and rebuilds the layout for it.
 */
 void get_terminal_size()
 {
-#ifdef _WIN32
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+    int width, height;
+    backend->get_size(&width, &height);
+    // only a change is stored, so headless games on several threads can share it
+    if (width != WIDTH || height != HEIGHT)
     {
-        WIDTH = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-        HEIGHT = csbi.srWindow.Bottom - csbi.srWindow.Top;
+        WIDTH = width;
+        HEIGHT = height;
     }
-    else
+    if (backend->draws)
     {
-        WIDTH = 80;
-        HEIGHT = 24;
+        frame_resize();
     }
-#else
-    struct winsize w;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0)
+}
+
+#ifdef SIGWINCH
+static void handle_sigwinch(int sig)
+{
+    (void)sig;
+    resize_pending = 1;
+}
+#endif
+
+/*
+screen_watch_resize : void
+Installs the SIGWINCH handler. It is installed without SA_RESTART, so a
+resize also wakes up a blocking read of the next command.
+*/
+void screen_watch_resize()
+{
+#ifdef SIGWINCH
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_sigwinch;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGWINCH, &sa, NULL);
+#endif
+}
+
+/*
+screen_take_resize : bool
+Returns true once per burst of resize events (several signals while the game
+was busy collapse into one), after re-reading the terminal size and rebuilding
+the layout. The caller then repaints the whole game once.
+*/
+bool screen_take_resize()
+{
+#ifdef SIGWINCH
+    if (!resize_pending)
     {
-        WIDTH = w.ws_col;
-        HEIGHT = w.ws_row - 1; // -1 idk but OS gives 1 extra
+        return false;
     }
-    else
+    resize_pending = 0;
+    // The terminal may have reflowed its contents even if the size ended up
+    // the same, so every signal leads to one repaint.
+    backend->get_size(&WIDTH, &HEIGHT);
+#else
+    // No resize signal here, so compare against the OS size instead.
+    int width, height;
+    backend->get_size(&width, &height);
+    if (width == WIDTH && height == HEIGHT)
     {
-        WIDTH = 80;
-        HEIGHT = 24;
+        return false;
     }
+    WIDTH = width;
+    HEIGHT = height;
 #endif
+    if (!backend->draws)
+    {
+        return false;
+    }
+    frame_resize();
+    return true;
 }
 /*
 ###################################
@@ -60,27 +597,33 @@ args:
 - x : int
 - y : int
 Moves cursor to desired x and y places. So user can print anything from that location.
+Like a real terminal, positions outside the screen are clamped to its edges.
 */
 void move_cursor(int x, int y)
 {
-    printf("\033[%d;%dH", y + 1, x + 1);
+    if (!backend->draws)
+    {
+        return;
+    }
+    cursor_x = x < 0 ? 0 : (x >= frame_cols ? frame_cols - 1 : x);
+    cursor_y = y < 0 ? 0 : (y >= frame_rows ? frame_rows - 1 : y);
 }
 
 void move_cursor_default()
 {
-    move_cursor(CMD_STRING_OFFSET_W, HEIGHT - CMD_STRING_OFFSET_S);
+    move_cursor(CMD_STRING_OFFSET_W, layout.input_y);
 }
 void move_cursor_output()
 {
-    move_cursor(CMD_OUTPUT_OFFSET_W, HEIGHT - CMD_OUTPUT_OFFSET_S);
+    move_cursor(CMD_OUTPUT_OFFSET_W, layout.output_y);
 }
 void move_cursor_info_1()
 {
-    move_cursor(CMD_OUTPUT_OFFSET_W, HEIGHT - CMD_OUTPUT_OFFSET_S - 4);
+    move_cursor(CMD_OUTPUT_OFFSET_W, layout.info_1_y);
 }
 void move_cursor_info_2()
 {
-    move_cursor(CMD_OUTPUT_OFFSET_W, HEIGHT - CMD_OUTPUT_OFFSET_S - 3);
+    move_cursor(CMD_OUTPUT_OFFSET_W, layout.info_2_y);
 }
 /*
 ###################################
@@ -89,62 +632,65 @@ void move_cursor_info_2()
 */
 void clear_input()
 {
-    // clear user input
-    move_cursor(CMD_STRING_OFFSET_W, HEIGHT - CMD_STRING_OFFSET_S);
-    for (int i = CMD_STRING_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
+    if (!backend->draws)
     {
-        printf(" ");
+        return;
     }
-    move_cursor(CMD_OUTPUT_OFFSET_W, HEIGHT - CMD_OUTPUT_OFFSET_S);
-    for (int i = CMD_OUTPUT_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf(" ");
-    }
-    move_cursor(CMD_STRING_OFFSET_W, HEIGHT - CMD_STRING_OFFSET_S);
+    // The terminal echoed the typed command on the input row behind our back,
+    // so whatever the front buffer says about that row (and where the cursor
+    // ended up) is stale now.
+    memset(frame_front + (size_t)layout.input_y * frame_cols, 0, frame_cols);
+    term_x = -1;
+    term_y = -1;
+    // clear user input
+    move_cursor_default();
+    frame_fill(' ', layout.line_end_x - CMD_STRING_OFFSET_W);
+    move_cursor_output();
+    frame_fill(' ', layout.line_end_x - CMD_OUTPUT_OFFSET_W);
+    move_cursor_default();
 }
 void clear_mobs()
 {
-    draw_text_center("                          ", ROOM_OFFSET_N + 3);
-    move_cursor(ROOM_OFFSET_W + 3, (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N);
-    printf("            ");
-    draw_text_center("                                      ", HEIGHT - (ROOM_OFFSET_S + 3));
-    move_cursor(WIDTH - ROOM_OFFSET_E - 15, (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N);
-    printf("            ");
+    draw_text_center("                          ", layout.guard_n_y);
+    move_cursor(layout.guard_w_x, layout.guard_we_y);
+    screen_print("            ");
+    draw_text_center("                                      ", layout.guard_s_y);
+    move_cursor(layout.guard_e_x, layout.guard_we_y);
+    screen_print("            ");
 
     move_cursor_output();
 }
 void clear_player_stats()
 {
-    move_cursor(CMD_OFFSET_W, HEIGHT - CMD_OFFSET_S + 1);
-    for (int i = CMD_OFFSET_W; i < ROOM_OFFSET_E - 1; i++)
-    {
-        printf(" ");
-    }
+    move_cursor(CMD_OFFSET_W, layout.stats_y + 2);
+    frame_fill(' ', ROOM_OFFSET_E - 1 - CMD_OFFSET_W);
     move_cursor_output();
 }
 
 void clear_item_drawing()
 {
     move_cursor(ROOM_OFFSET_W + 6, ROOM_OFFSET_N + 6);
-    printf("                    ");
+    screen_print("                    ");
     move_cursor_output();
 }
+/*
+get_info_width : int
+Returns how many columns the info lines can hold.
+*/
+int get_info_width()
+{
+    return layout.line_end_x - CMD_OFFSET_W;
+}
 void clear_info_1()
 {
     move_cursor_info_1();
-    for (int i = CMD_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf(" ");
-    }
+    frame_fill(' ', layout.line_end_x - CMD_OFFSET_W);
     move_cursor_output();
 }
 void clear_info_2()
 {
     move_cursor_info_2();
-    for (int i = CMD_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf(" ");
-    }
+    frame_fill(' ', layout.line_end_x - CMD_OFFSET_W);
     move_cursor_output();
 }
 /*
@@ -158,49 +704,51 @@ Draw game borders and input-output & inventory area. This is for decoration purp
 */
 void draw_borders()
 {
+    if (!backend->draws)
+    {
+        return;
+    }
     clear_console();
+    memcpy(frame_back, border_frame, (size_t)frame_cols * frame_rows);
 
+    change_info_title("> ROOM <");
+}
+/*
+draw_border_lines : void
+Draws the border lines cell by cell. Only used to build border_frame.
+*/
+static void draw_border_lines()
+{
     move_cursor(0, 0);
 
-    printf("+"); // left corner
+    frame_fill('+', 1); // left corner
     // top
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("-");
-    }
+    frame_fill('-', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     // right corner
-    printf("+");
+    frame_fill('+', 1);
     // left wall
     for (int i = ROOM_OFFSET_N; i < HEIGHT; i++)
     {
         move_cursor(0, i);
-        printf("|");
+        frame_fill('|', 1);
     }
     move_cursor(0, HEIGHT);
-    printf("+");
+    frame_fill('+', 1);
     // below
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("-");
-    }
+    frame_fill('-', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     move_cursor(WIDTH - ROOM_OFFSET_E, HEIGHT);
-    printf("+");
+    frame_fill('+', 1);
     // right wall
     for (int i = ROOM_OFFSET_W; i < HEIGHT; i++)
     {
         move_cursor(WIDTH, i);
-        printf("|");
+        frame_fill('|', 1);
     }
     // inventory and command prompt
     move_cursor(0, HEIGHT - ROOM_OFFSET_S + 1);
-    printf("+");
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("-");
-    }
-    printf("+");
-
-    change_info_title("> ROOM <");
+    frame_fill('+', 1);
+    frame_fill('-', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
+    frame_fill('+', 1);
 }
 /*
 draw_text : void
@@ -214,7 +762,7 @@ Draws text to desired x and y coordinates in the screen.
 void draw_text(const char *text, int x, int y)
 {
     move_cursor(x, y);
-    printf("%s", text);
+    frame_write(text, strlen(text));
 }
 /*
 draw_text_center : void
@@ -225,10 +773,17 @@ Draws centered-text to desired row (y).
 */
 void draw_text_center(const char *text, int y, ...)
 {
+    if (!backend->draws)
+    {
+        return;
+    }
+    char line[512];
     va_list args;
     va_start(args, text);
-    move_cursor(WIDTH / 2 - strlen(text) / 2, y);
-    vprintf(text, args);
+    vsnprintf(line, sizeof(line), text, args);
+    va_end(args);
+    move_cursor(WIDTH / 2 - (int)strlen(text) / 2, y);
+    frame_write(line, strlen(line));
 }
 /*
 draw_text_center : void
@@ -236,8 +791,8 @@ Prints "COMMAND: " string to specific place.
 */
 void draw_input_text()
 {
-    move_cursor(CMD_OFFSET_W, HEIGHT - CMD_OFFSET_S);
-    printf("COMMAND: ");
+    move_cursor(CMD_OFFSET_W, layout.input_y);
+    screen_print("COMMAND: ");
 }
 
 void draw_war_info(Player *pl)
@@ -246,36 +801,71 @@ void draw_war_info(Player *pl)
     clear_info_2();
     change_info_title("> ATTACK <");
     move_cursor_info_1();
-    printf("Player vs %s! [ Commands : HIT KICK FLEE] (Flee chance: %.1f%%)", enemy_get_simple_name(pl->room->mobs[pl->warIndex].type), pl->room->mobs[pl->warIndex].flee_chance * 100);
+    screen_print("Player vs %s! [ Commands : HIT KICK FLEE] (Flee chance: %.1f%%)", enemy_get_simple_name(pl->room->mobs[pl->warIndex].type), pl->room->mobs[pl->warIndex].flee_chance * 100);
     move_cursor_info_2();
-    printf("> %s HEALTH: %.1f | STRENGTH: %.1f", enemy_get_simple_name(pl->room->mobs[pl->warIndex].type), pl->room->mobs[pl->warIndex].health, pl->room->mobs[pl->warIndex].damage);
+    screen_print("> %s HEALTH: %.1f | STRENGTH: %.1f", enemy_get_simple_name(pl->room->mobs[pl->warIndex].type), pl->room->mobs[pl->warIndex].health, pl->room->mobs[pl->warIndex].damage);
 }
 void draw_item(Item *i)
 {
     if (i->type != ITEM_NONE && i->looted == false)
     {
         move_cursor(ROOM_OFFSET_W + 6, ROOM_OFFSET_N + 6);
-        printf("[ %s ]", i->name);
+        screen_print("[ %s ]", names_get(i->name));
     }
 }
 
+/*
+draw_game : void
+args:
+- pl : Player *
+Draws the whole game screen for the player's current state: borders, title,
+prompt, room and stats, plus the fight or game over info when relevant.
+*/
+void draw_game(Player *pl)
+{
+    if (!backend->draws)
+    {
+        return;
+    }
+    draw_borders();
+    draw_text_center("> Dungeons of AYBU <", 0);
+    draw_input_text();
+    draw_dungeon(pl->room);
+    draw_player_stats(pl);
+    if (pl->health <= 0)
+    {
+        draw_game_over(pl);
+    }
+    else if (pl->onWar)
+    {
+        draw_war_info(pl);
+    }
+}
+
+/*
+draw_dungeon : void
+args:
+- r : Room *
+Copies the prebuilt frame for the room's doors (walls and player) over the
+room area, then draws what the player has found in it.
+*/
 void draw_dungeon(Room *r)
 {
-    clear_item_drawing();
-    clear_mobs();
-    // Print walls
-    game_print_north_wall((r->doors & 0b1000) >> 3);
-    game_print_east_wall((r->doors & 0b0100) >> 2);
-    game_print_south_wall((r->doors & 0b0010) >> 1);
-    game_print_west_wall((r->doors & 0b0001));
+    if (!backend->draws)
+    {
+        return;
+    }
+    const char *room = room_frames + (size_t)(r->doors & 0b1111) * room_area_w * room_area_h;
+    for (int i = 0; i < room_area_h; i++)
+    {
+        memcpy(frame_back + (size_t)(room_area_y + i) * frame_cols + room_area_x, room + (size_t)i * room_area_w, room_area_w);
+    }
 
     if (r->searched)
     {
         draw_mobs(r->mobs);
         draw_item(&r->item);
     }
-    // Print player
-    draw_player();
 
     change_info_to_room(r);
 
@@ -301,24 +891,24 @@ void draw_mobs(Enemy *mobs)
     if (mobs[3].type != ENEMY_NONE && mobs[3].health > 0)
     {
         // north guard
-        draw_text_center(enemy_get_name(mobs[3].type), ROOM_OFFSET_N + 3);
+        draw_text_center(enemy_get_name(mobs[3].type), layout.guard_n_y);
     }
     if (mobs[0].type != ENEMY_NONE && mobs[0].health > 0)
     {
         // west guard
-        move_cursor(ROOM_OFFSET_W + 3, (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N);
-        printf("%s", enemy_get_name(mobs[0].type));
+        move_cursor(layout.guard_w_x, layout.guard_we_y);
+        screen_print("%s", enemy_get_name(mobs[0].type));
     }
     if (mobs[1].type != ENEMY_NONE && mobs[1].health > 0)
     {
         // south guard
-        draw_text_center(enemy_get_name(mobs[1].type), HEIGHT - (ROOM_OFFSET_S + 3));
+        draw_text_center(enemy_get_name(mobs[1].type), layout.guard_s_y);
     }
     if (mobs[2].type != ENEMY_NONE && mobs[2].health > 0)
     {
         // east guard
-        move_cursor(WIDTH - ROOM_OFFSET_E - 15, (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N);
-        printf("%s", enemy_get_name(mobs[2].type));
+        move_cursor(layout.guard_e_x, layout.guard_we_y);
+        screen_print("%s", enemy_get_name(mobs[2].type));
     }
 
     move_cursor_output();
@@ -327,12 +917,12 @@ void draw_mobs(Enemy *mobs)
 void draw_player_stats(Player *pl)
 {
     clear_player_stats();
-    move_cursor(CMD_OFFSET_W, HEIGHT - CMD_OFFSET_S - 1);
+    move_cursor(CMD_OFFSET_W, layout.stats_y);
     float total_strength = pl->strength;
     float total_defence = pl->defence;
     float total_crit_rate = pl->crit_rate;
     float total_crit_chance = pl->crit_chance;
-    printf("> PLAYER HEALTH: %.1f/%.1f | STRENGTH: %.1f | DEFENCE: %.1f | CRIT RATE: %.1f | CRIT CHANCE: %.1f", pl->health, pl->maxHealth, total_strength, total_defence, total_crit_rate, total_crit_chance);
+    screen_print("> PLAYER HEALTH: %.1f/%.1f | STRENGTH: %.1f | DEFENCE: %.1f | CRIT RATE: %.1f | CRIT CHANCE: %.1f", pl->health, pl->maxHealth, total_strength, total_defence, total_crit_rate, total_crit_chance);
 }
 void draw_game_over(Player *pl)
 {
@@ -345,15 +935,26 @@ void draw_game_over(Player *pl)
 
 void draw_output_text(const char *format, ...)
 {
+    if (!backend->draws)
+    {
+        return;
+    }
+    char line[512];
     va_list args;
     va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
     move_cursor_output();
-    vprintf(format, args);
+    frame_write(line, strlen(line));
     move_cursor_output();
 }
 
 void draw_inventory(Player *pl)
 {
+    if (!backend->draws)
+    {
+        return;
+    }
     clear_info_1();
     clear_info_2();
     move_cursor_info_1();
@@ -363,7 +964,7 @@ void draw_inventory(Player *pl)
         memset(result, 0, sizeof(result));
         if (pl->inventory[i].type != ITEM_NONE)
         {
-            sprintf(result, ">> [%s] ", pl->inventory[i].name);
+            sprintf(result, ">> [%s] ", names_get(pl->inventory[i].name));
             if (pl->inventory[i].health != 0)
             {
                 sprintf(result, "%sHP: %.1f ", result, pl->inventory[i].health);
@@ -384,7 +985,7 @@ void draw_inventory(Player *pl)
             {
                 sprintf(result, "%sST: %.1f ", result, pl->inventory[i].strength);
             }
-            printf("%s<<", result);
+            screen_print("%s<<", result);
         }
         if ((float)(PLAYER_INV_SIZE / 2) == (float)(i + 1))
         {
@@ -399,16 +1000,22 @@ void draw_inventory(Player *pl)
 */
 void change_info_to_room(Room *r)
 {
+    if (!backend->draws)
+    {
+        return;
+    }
     clear_info_1();
     clear_info_2();
     move_cursor_info_1();
     if (r->searched)
     {
-        printf("ROOM NAME: %s | ENEMIES: %s | ITEM: %s | OPEN DOORS: %s", r->name, room_get_enemy_names(r), room_get_item_name(r), room_get_open_doors(r));
+        char enemies[ROOM_ENEMY_NAMES_LENGTH];
+        room_get_enemy_names(r, enemies, sizeof(enemies));
+        screen_print("ROOM NAME: %s | ENEMIES: %s | ITEM: %s | OPEN DOORS: %s", names_get(r->name), enemies, room_get_item_name(r), room_get_open_doors(r));
     }
     else
     {
-        printf("ROOM NAME: ????? | ENEMIES: ????? | ITEM: ????? | OPEN DOORS: ?????");
+        screen_print("ROOM NAME: ????? | ENEMIES: ????? | ITEM: ????? | OPEN DOORS: ?????");
     }
 }
 void change_info_to_help()
@@ -416,9 +1023,9 @@ void change_info_to_help()
     clear_info_1();
     clear_info_2();
     move_cursor_info_1();
-    printf("Available Game Commands: look, move, inventory, attack, pickup, drop");
+    screen_print("Available Game Commands: look, move, goto, inventory, attack, pickup, drop");
     move_cursor_info_2();
-    printf("Available Menu Commands: list, save, load, exit");
+    screen_print("Available Menu Commands: list, save, load, exit");
     move_cursor_output();
 }
 /*
@@ -429,14 +1036,13 @@ Draws text to title place.
 */
 void change_info_title(char *text)
 {
-    move_cursor(0, HEIGHT - ROOM_OFFSET_S + 1);
-    printf("+");
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
+    if (!backend->draws)
     {
-        printf("-");
+        return;
     }
-    printf("+");
-    draw_text_center(text, HEIGHT - ROOM_OFFSET_S + 1);
+    size_t row = (size_t)layout.title_y * frame_cols;
+    memcpy(frame_back + row, border_frame + row, frame_cols);
+    draw_text_center(text, layout.title_y);
 }
 /*
 ###################################
@@ -460,7 +1066,7 @@ void open_door_west()
     for (int i = (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N - 2; i < (HEIGHT - ROOM_OFFSET_S) / 2 + 3 + ROOM_OFFSET_N; i++)
     {
         move_cursor(ROOM_OFFSET_W, i);
-        printf("  ");
+        frame_fill(' ', 2);
     }
 }
 
@@ -469,7 +1075,7 @@ void open_door_east()
     for (int i = (HEIGHT - ROOM_OFFSET_S - ROOM_OFFSET_N) / 2 + ROOM_OFFSET_N - 2; i < (HEIGHT - ROOM_OFFSET_S) / 2 + 3 + ROOM_OFFSET_N; i++)
     {
         move_cursor(WIDTH - ROOM_OFFSET_E - 2, i);
-        printf("  ");
+        frame_fill(' ', 2);
     }
 }
 /*
@@ -480,15 +1086,9 @@ void open_door_east()
 void game_print_north_wall(unsigned char isOpen)
 {
     move_cursor(ROOM_OFFSET_W, ROOM_OFFSET_N);
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("#");
-    }
+    frame_fill('#', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     move_cursor(ROOM_OFFSET_W, ROOM_OFFSET_N + 1);
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("#");
-    }
+    frame_fill('#', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     if (isOpen)
     {
         open_door_north();
@@ -497,15 +1097,9 @@ void game_print_north_wall(unsigned char isOpen)
 void game_print_south_wall(unsigned char isOpen)
 {
     move_cursor(ROOM_OFFSET_W, HEIGHT - ROOM_OFFSET_S);
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("#");
-    }
+    frame_fill('#', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     move_cursor(ROOM_OFFSET_W, HEIGHT - ROOM_OFFSET_S - 1);
-    for (int i = ROOM_OFFSET_W; i < WIDTH - ROOM_OFFSET_E; i++)
-    {
-        printf("#");
-    }
+    frame_fill('#', WIDTH - ROOM_OFFSET_E - ROOM_OFFSET_W);
     if (isOpen)
     {
         open_door_south();
@@ -517,7 +1111,7 @@ void game_print_west_wall(unsigned char isOpen)
     for (int i = ROOM_OFFSET_N; i < HEIGHT - ROOM_OFFSET_S; i++)
     {
         move_cursor(1, i);
-        printf("##");
+        frame_fill('#', 2);
     }
     if (isOpen)
     {
@@ -530,7 +1124,7 @@ void game_print_east_wall(unsigned char isOpen)
     for (int i = ROOM_OFFSET_N; i < HEIGHT - ROOM_OFFSET_S; i++)
     {
         move_cursor(WIDTH - ROOM_OFFSET_E - 2, i);
-        printf("##");
+        frame_fill('#', 2);
     }
     if (isOpen)
     {
@@ -0,0 +1,1136 @@
+#include "world.h"
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+_Static_assert(WORLD_CACHE_CHUNKS >= 1 && WORLD_CACHE_CHUNKS * 2 <= WORLD_CHUNK_SLOTS,
+               "WORLD_CACHE_BYTES must fit 1 to WORLD_CHUNK_SLOTS / 2 chunks");
+
+// session_<name>.chunks, set before the first chunk is spilled
+static char world_spill_path[96] = "session_default.chunks";
+
+/* @
+ * world_chunk_hash: uint32_t
+ * ---------------------------
+ * Hash of a chunk coordinate, for the resident and spilled chunk indexes.
+ */
+static uint32_t world_chunk_hash(int32_t cx, int32_t cy) {
+    uint64_t h = ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+/* @
+ * world_chunk_of: int32_t
+ * ------------------------
+ * Chunk coordinate of a room coordinate (rounded down, also for negative ones).
+ */
+static int32_t world_chunk_of(int32_t v) {
+    return (v - (v & (WORLD_CHUNK - 1))) / WORLD_CHUNK;
+}
+static WorldRoom *world_chunk_room(WorldChunk *c, int32_t x, int32_t y) {
+    return &c->rooms[(y & (WORLD_CHUNK - 1)) * WORLD_CHUNK + (x & (WORLD_CHUNK - 1))];
+}
+/* @
+ * world_set_session: void
+ * ------------------------
+ * Names the file cold chunks are spilled to, session_<name>.chunks.
+ * Call it before the game starts.
+ */
+void world_set_session(const char *session) {
+    snprintf(world_spill_path, sizeof(world_spill_path), "session_%s.chunks", session);
+}
+/* @
+ * world_set_spill_session: void
+ * ------------------------------
+ * Gives one world its own chunk file, session_<name>.chunks, so several games
+ * can run in one process. Call it on the zeroed World before its first reset;
+ * worlds without one use the file named by world_set_session.
+ */
+void world_set_spill_session(World *w, const char *session) {
+    snprintf(w->spill_path, sizeof(w->spill_path), "session_%s.chunks", session);
+}
+/* @
+ * world_close: void
+ * ------------------
+ * Closes the session's chunk file.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - keep: bool - Leave the file for the next start: the session's snapshot
+ *   refers to its records (see world_import). Otherwise it is removed, saves
+ *   carry their own copy of the map.
+ */
+void world_close(World *w, bool keep) {
+    if (w != NULL && w->spill != NULL) {
+        fclose(w->spill);
+        w->spill = NULL;
+        if (!keep) {
+            remove(w->spill_path);
+        }
+    }
+}
+/* @
+ * world_resident: WorldChunk*
+ * ----------------------------
+ * The chunk at (cx, cy) if it is in memory, without touching the LRU list.
+ */
+static WorldChunk *world_resident(World *w, int32_t cx, int32_t cy) {
+    uint32_t i = world_chunk_hash(cx, cy) & (WORLD_CHUNK_SLOTS - 1);
+    while (w->slots[i] != 0) {
+        WorldChunk *c = &w->chunks[w->slots[i] - 1];
+        if (c->cx == cx && c->cy == cy) {
+            return c;
+        }
+        i = (i + 1) & (WORLD_CHUNK_SLOTS - 1);
+    }
+    return NULL;
+}
+/* @
+ * world_unslot: void
+ * -------------------
+ * Removes a chunk from the resident index, shifting back the entries that
+ * probed past it so lookups don't stop early.
+ */
+static void world_unslot(World *w, uint16_t n) {
+    WorldChunk *c = &w->chunks[n];
+    uint32_t i = world_chunk_hash(c->cx, c->cy) & (WORLD_CHUNK_SLOTS - 1);
+    while (w->slots[i] != n + 1) {
+        i = (i + 1) & (WORLD_CHUNK_SLOTS - 1);
+    }
+    uint32_t j = i;
+    while (1) {
+        j = (j + 1) & (WORLD_CHUNK_SLOTS - 1);
+        if (w->slots[j] == 0) {
+            break;
+        }
+        WorldChunk *o = &w->chunks[w->slots[j] - 1];
+        uint32_t home = world_chunk_hash(o->cx, o->cy) & (WORLD_CHUNK_SLOTS - 1);
+        // move it into the hole unless its home lies cyclically in (i, j]
+        if (((j - home) & (WORLD_CHUNK_SLOTS - 1)) >= ((j - i) & (WORLD_CHUNK_SLOTS - 1))) {
+            w->slots[i] = w->slots[j];
+            i = j;
+        }
+    }
+    w->slots[i] = 0;
+}
+static void world_slot_in(World *w, uint16_t n) {
+    WorldChunk *c = &w->chunks[n];
+    uint32_t i = world_chunk_hash(c->cx, c->cy) & (WORLD_CHUNK_SLOTS - 1);
+    while (w->slots[i] != 0) {
+        i = (i + 1) & (WORLD_CHUNK_SLOTS - 1);
+    }
+    w->slots[i] = n + 1;
+}
+/* @
+ * world_touch: void
+ * ------------------
+ * Moves a chunk to the front of the LRU list.
+ */
+static void world_touch(World *w, uint16_t n) {
+    WorldChunk *c = &w->chunks[n];
+    if (w->head == n) {
+        return;
+    }
+    // unlink (a chunk that is not linked yet has prev == next == WORLD_NO_CHUNK and isn't the tail)
+    if (c->prev != WORLD_NO_CHUNK) w->chunks[c->prev].next = c->next;
+    if (c->next != WORLD_NO_CHUNK) w->chunks[c->next].prev = c->prev;
+    if (w->tail == n) w->tail = c->prev;
+    c->prev = WORLD_NO_CHUNK;
+    c->next = w->head;
+    if (w->head != WORLD_NO_CHUNK) w->chunks[w->head].prev = n;
+    w->head = n;
+    if (w->tail == WORLD_NO_CHUNK) w->tail = n;
+}
+/* @
+ * world_spilled: WorldSpilled*
+ * -----------------------------
+ * Finds the spill file entry of a chunk, or the empty slot where it goes.
+ */
+static WorldSpilled *world_spilled(World *w, int32_t cx, int32_t cy) {
+    if (w->spilled_capacity == 0) {
+        return NULL;
+    }
+    uint32_t i = world_chunk_hash(cx, cy) & (w->spilled_capacity - 1);
+    while (w->spilled[i].record != 0 && (w->spilled[i].cx != cx || w->spilled[i].cy != cy)) {
+        i = (i + 1) & (w->spilled_capacity - 1);
+    }
+    return &w->spilled[i];
+}
+/* @
+ * world_spilled_add: WorldSpilled*
+ * ---------------------------------
+ * Adds a chunk to the spill file index, growing it to keep it at most half
+ * full. The caller sets the entry's record.
+ *
+ * Returns:
+ * - The new entry, or NULL if out of memory.
+ */
+static WorldSpilled *world_spilled_add(World *w, int32_t cx, int32_t cy) {
+    if ((w->spilled_count + 1) * 2 > w->spilled_capacity) {
+        uint32_t capacity = w->spilled_capacity == 0 ? 256 : w->spilled_capacity * 2;
+        WorldSpilled *grown = calloc(capacity, sizeof(WorldSpilled));
+        if (grown == NULL) {
+            return NULL;
+        }
+        WorldSpilled *old = w->spilled;
+        uint32_t old_capacity = w->spilled_capacity;
+        w->spilled = grown;
+        w->spilled_capacity = capacity;
+        for (uint32_t i = 0; i < old_capacity; i++) {
+            if (old[i].record != 0) {
+                *world_spilled(w, old[i].cx, old[i].cy) = old[i];
+            }
+        }
+        free(old);
+    }
+    WorldSpilled *e = world_spilled(w, cx, cy);
+    e->cx = cx;
+    e->cy = cy;
+    w->spilled_count++;
+    return e;
+}
+/* @
+ * world_record_take: uint32_t
+ * ----------------------------
+ * Finds a spill file record nothing refers to: a freed one, or a new one at
+ * the end of the file. It starts with one reference.
+ *
+ * Returns:
+ * - The record number + 1, or 0 if out of memory.
+ */
+static uint32_t world_record_take(World *w) {
+    uint32_t record;
+    if (w->free_count > 0) {
+        record = w->free_records[--w->free_count];
+    } else {
+        if (w->records == w->records_capacity) {
+            uint32_t capacity = w->records_capacity == 0 ? 256 : w->records_capacity * 2;
+            uint16_t *refs = realloc(w->record_refs, capacity * sizeof(uint16_t));
+            if (refs == NULL) {
+                return 0;
+            }
+            w->record_refs = refs;
+            uint32_t *free_records = realloc(w->free_records, capacity * sizeof(uint32_t));
+            if (free_records == NULL) {
+                return 0;
+            }
+            w->free_records = free_records;
+            w->records_capacity = capacity;
+        }
+        record = ++w->records;
+    }
+    w->record_refs[record - 1] = 1;
+    return record;
+}
+static void world_record_drop(World *w, uint32_t record) {
+    if (--w->record_refs[record - 1] == 0) {
+        w->free_records[w->free_count++] = record;
+    }
+}
+static void world_put(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+static uint32_t world_get(const unsigned char *p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+/* @
+ * world_spill: bool
+ * ------------------
+ * Writes a chunk to its record in the spill file (little-endian, see
+ * WORLD_CHUNK_RECORD), opening the file on first use. A record an image still
+ * reads from is left as it is, the chunk moves to another one.
+ *
+ * Returns:
+ * - false if the chunk could not be written, its index entry is then unchanged.
+ */
+static bool world_spill(World *w, WorldChunk *c) {
+    if (w->spill == NULL) {
+        w->spill = fopen(w->spill_path, "w+b");
+        if (w->spill == NULL) {
+            return false;
+        }
+    }
+    WorldSpilled *e = world_spilled(w, c->cx, c->cy);
+    uint32_t old = e != NULL ? e->record : 0;
+    uint32_t record = old;
+    if (old == 0 || w->record_refs[old - 1] > 1) {
+        record = world_record_take(w);
+        if (record == 0) {
+            return false;
+        }
+    }
+    unsigned char data[WORLD_CHUNK_RECORD];
+    world_put(data, (uint32_t)c->cx);
+    world_put(data + 4, (uint32_t)c->cy);
+    unsigned char *p = data + 8;
+    for (int i = 0; i < WORLD_CHUNK_ROOMS; i++, p += 10) {
+        world_put(p, c->rooms[i].index);
+        world_put(p + 4, c->rooms[i].last_visit);
+        p[8] = c->rooms[i].doors;
+        p[9] = c->rooms[i].state;
+    }
+    if (fseek(w->spill, (long)(record - 1) * WORLD_CHUNK_RECORD, SEEK_SET) != 0
+        || fwrite(data, WORLD_CHUNK_RECORD, 1, w->spill) != 1) {
+        if (record != old) {
+            world_record_drop(w, record);
+        }
+        return false;
+    }
+    if (old == 0) {
+        e = world_spilled_add(w, c->cx, c->cy);
+        if (e == NULL) {
+            world_record_drop(w, record);
+            return false;
+        }
+    } else if (record != old) {
+        world_record_drop(w, old);
+    }
+    e->record = record;
+    e->count = c->count;
+    w->chunk_spills++;
+    return true;
+}
+/* @
+ * world_decode: bool
+ * -------------------
+ * Fills a chunk from a spill file record, checking it is the record of e.
+ */
+static bool world_decode(const unsigned char *data, WorldSpilled *e, WorldChunk *c) {
+    if ((int32_t)world_get(data) != e->cx || (int32_t)world_get(data + 4) != e->cy) {
+        return false;
+    }
+    c->count = 0;
+    const unsigned char *p = data + 8;
+    for (int i = 0; i < WORLD_CHUNK_ROOMS; i++, p += 10) {
+        WorldRoom *rec = &c->rooms[i];
+        rec->x = e->cx * WORLD_CHUNK + i % WORLD_CHUNK;
+        rec->y = e->cy * WORLD_CHUNK + i / WORLD_CHUNK;
+        rec->index = world_get(p);
+        rec->last_visit = world_get(p + 4);
+        rec->doors = p[8];
+        rec->state = p[9];
+        if (rec->state & WORLD_ROOM_USED) {
+            c->count++;
+        }
+    }
+    return true;
+}
+/* @
+ * world_unspill: bool
+ * --------------------
+ * Reads a chunk back from its record in the spill file.
+ */
+static bool world_unspill(World *w, WorldSpilled *e, WorldChunk *c) {
+    unsigned char data[WORLD_CHUNK_RECORD];
+    return w->spill != NULL
+        && fseek(w->spill, (long)(e->record - 1) * WORLD_CHUNK_RECORD, SEEK_SET) == 0
+        && fread(data, WORLD_CHUNK_RECORD, 1, w->spill) == 1
+        && world_decode(data, e, c);
+}
+/* @
+ * world_free_chunk: uint16_t
+ * ---------------------------
+ * Finds memory for one more chunk: an unused one while the budget allows,
+ * otherwise the least recently used chunk, written to the spill file first
+ * if it changed since it was read. If it can't be written its rooms are
+ * forgotten.
+ *
+ * Returns:
+ * - The chunk number, unlinked from the LRU list and the resident index.
+ */
+static uint16_t world_free_chunk(World *w) {
+    if (w->resident < WORLD_CACHE_CHUNKS) {
+        return w->resident++;
+    }
+    uint16_t n = w->tail;
+    WorldChunk *c = &w->chunks[n];
+    if (c->dirty && !world_spill(w, c)) {
+        w->count -= c->count;
+        w->forgot = true;
+        w->version++;
+    }
+    world_unslot(w, n);
+    w->tail = c->prev;
+    if (w->tail != WORLD_NO_CHUNK) w->chunks[w->tail].next = WORLD_NO_CHUNK;
+    if (w->head == n) w->head = WORLD_NO_CHUNK;
+    return n;
+}
+/* @
+ * world_chunk: WorldChunk*
+ * -------------------------
+ * Finds the chunk at (cx, cy), reading it back from the spill file if it was
+ * evicted, and marks it most recently used. Earlier chunk pointers may be
+ * recycled by this call.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - cx, cy: int32_t - Chunk coordinates.
+ * - create: bool - Make an empty chunk if there is none yet.
+ *
+ * Returns:
+ * - The chunk, or NULL if it doesn't exist and create is false.
+ */
+static WorldChunk *world_chunk(World *w, int32_t cx, int32_t cy, bool create) {
+    WorldChunk *c = world_resident(w, cx, cy);
+    if (c != NULL) {
+        w->chunk_hits++;
+        world_touch(w, (uint16_t)(c - w->chunks));
+        return c;
+    }
+    WorldSpilled *e = world_spilled(w, cx, cy);
+    bool spilled = e != NULL && e->record != 0;
+    if (!spilled && !create) {
+        return NULL;
+    }
+    uint16_t n = world_free_chunk(w);
+    c = &w->chunks[n];
+    memset(c, 0, sizeof(*c));
+    c->cx = cx;
+    c->cy = cy;
+    c->prev = c->next = WORLD_NO_CHUNK;
+    if (spilled) {
+        w->chunk_misses++;
+        // eviction above may have grown the spill index, look the entry up again
+        if (!world_unspill(w, world_spilled(w, cx, cy), c)) {
+            memset(c->rooms, 0, sizeof(c->rooms));
+            c->count = 0;
+            w->forgot = true;
+            w->version++;
+        }
+    } else {
+        c->dirty = true;
+    }
+    world_slot_in(w, n);
+    world_touch(w, n);
+    return c;
+}
+/* @
+ * world_known: bool
+ * ------------------
+ * Whether the room at (x, y) is (probably) known, without reading chunks
+ * back: rooms of spilled chunks count as known.
+ */
+static bool world_known(World *w, int32_t x, int32_t y) {
+    int32_t cx = world_chunk_of(x), cy = world_chunk_of(y);
+    WorldChunk *c = world_resident(w, cx, cy);
+    if (c != NULL) {
+        return (world_chunk_room(c, x, y)->state & WORLD_ROOM_USED) != 0;
+    }
+    WorldSpilled *e = world_spilled(w, cx, cy);
+    return e != NULL && e->record != 0;
+}
+/* @
+ * world_step: void
+ * -----------------
+ * Moves a coordinate one room in a direction (0: west, 1: south, 2: east,
+ * 3: north, the same numbering as doors and mobs).
+ */
+void world_step(int direction, int32_t *x, int32_t *y) {
+    static const int dx[] = { -1, 0, 1, 0 };
+    static const int dy[] = { 0, 1, 0, -1 };
+    *x += dx[direction];
+    *y += dy[direction];
+}
+/* @
+ * world_clear: void
+ * ------------------
+ * Forgets every room, keeping the spill file, its name and its index for
+ * reuse (records no image reads are overwritten). The world seed is left to
+ * the caller.
+ */
+static void world_clear(World *w, bool procedural) {
+    for (uint32_t i = 0; i < w->spilled_capacity; i++) {
+        if (w->spilled[i].record != 0) {
+            world_record_drop(w, w->spilled[i].record);
+        }
+    }
+    FILE *spill = w->spill;
+    WorldSpilled *spilled = w->spilled;
+    uint32_t spilled_capacity = w->spilled_capacity;
+    uint16_t *record_refs = w->record_refs;
+    uint32_t *free_records = w->free_records;
+    uint32_t free_count = w->free_count, records = w->records, records_capacity = w->records_capacity;
+    uint32_t version = w->version;
+    char spill_path[sizeof(w->spill_path)];
+    memcpy(spill_path, w->spill_path[0] != '\0' ? w->spill_path : world_spill_path, sizeof(spill_path));
+    memset(w, 0, sizeof(*w));
+    w->version = version + 1;
+    memcpy(w->spill_path, spill_path, sizeof(spill_path));
+    w->spill = spill;
+    w->spilled = spilled;
+    w->spilled_capacity = spilled_capacity;
+    if (spilled != NULL) {
+        memset(spilled, 0, spilled_capacity * sizeof(WorldSpilled));
+    }
+    w->record_refs = record_refs;
+    w->free_records = free_records;
+    w->free_count = free_count;
+    w->records = records;
+    w->records_capacity = records_capacity;
+    w->head = w->tail = WORLD_NO_CHUNK;
+    w->procedural = procedural;
+}
+/* @
+ * world_reset: void
+ * ------------------
+ * Forgets every room, e.g. when a new game starts, and picks how rooms are made.
+ * The spill file, its name and its index are kept for reuse, their records are overwritten.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - procedural: bool - true: every room is a pure function of (world seed, x, y)
+ *   and only rooms the player changed are stored. false: rooms are rolled when
+ *   first entered and every visited room is stored.
+ * - session: Rng* - Session generator, the world seed is forked from it.
+ */
+void world_reset(World *w, bool procedural, Rng *session) {
+    world_clear(w, procedural);
+    Rng world_rng;
+    rng_fork(session, &world_rng, RNG_DOMAIN_WORLD, 0);
+    w->seed = ((uint64_t)rng_next(&world_rng) << 32) | rng_next(&world_rng);
+}
+/* @
+ * world_hash: uint64_t
+ * ---------------------
+ * Mixes the world seed with a coordinate and a salt (splitmix64 finalizer).
+ */
+static uint64_t world_hash(uint64_t seed, int32_t x, int32_t y, uint64_t salt) {
+    uint64_t h = seed ^ (((uint64_t)(uint32_t)x << 32) | (uint32_t)y) ^ (salt * 0x9E3779B97F4A7C15ull);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+/* @
+ * world_carves_west: bool
+ * ------------------------
+ * Whether the procedural maze opens the door between (x - 1, y) and (x, y).
+ * Inside each WORLD_BLOCK square every room opens its west or north door
+ * (a binary tree maze), rooms on the block's top row go west, rooms on its
+ * left column go north, and the block's corner room opens both, joining the
+ * block to its west and north neighbors. So every room is reachable from
+ * every other one, and WORLD_EXTRA_DOORS more doors add loops.
+ */
+static bool world_carves_west(uint64_t seed, int32_t x, int32_t y) {
+    int32_t lx = x & (WORLD_BLOCK - 1), ly = y & (WORLD_BLOCK - 1);
+    uint64_t h = world_hash(seed, x, y, 1);
+    if (ly == 0 || (lx != 0 && (h & 1))) {
+        return true;
+    }
+    return (h >> 8) % 100 < WORLD_EXTRA_DOORS;
+}
+static bool world_carves_north(uint64_t seed, int32_t x, int32_t y) {
+    int32_t lx = x & (WORLD_BLOCK - 1), ly = y & (WORLD_BLOCK - 1);
+    uint64_t h = world_hash(seed, x, y, 1);
+    if (lx == 0 || (ly != 0 && !(h & 1))) {
+        return true;
+    }
+    return (h >> 16) % 100 < WORLD_EXTRA_DOORS;
+}
+/* @
+ * world_doors: unsigned char
+ * ---------------------------
+ * Doors of the procedural room at (x, y). Every door is decided by the edge
+ * it sits on, so neighbors always agree without storing anything.
+ */
+static unsigned char world_doors(uint64_t seed, int32_t x, int32_t y) {
+    unsigned char doors = 0;
+    if (world_carves_west(seed, x, y)) doors |= 0b0001;
+    if (world_carves_north(seed, x, y + 1)) doors |= 0b0010;
+    if (world_carves_west(seed, x + 1, y)) doors |= 0b0100;
+    if (world_carves_north(seed, x, y)) doors |= 0b1000;
+    return doors;
+}
+/* @
+ * world_generate: void
+ * ---------------------
+ * Builds the procedural room at (x, y) in O(1), using a counter-based
+ * generator keyed by the world seed with the coordinates as its stream.
+ */
+static void world_generate(World *w, int32_t x, int32_t y, Room *r) {
+    Rng room_rng;
+    rng_seed_counter(&room_rng, w->seed);
+    room_rng.stream = ((uint64_t)RNG_DOMAIN_ROOM << 56)
+        ^ ((uint64_t)((uint32_t)x & 0xFFFFFFF) << 28) ^ ((uint32_t)y & 0xFFFFFFF);
+    room_create_random(r, 0, &room_rng);
+    r->doors = world_doors(w->seed, x, y);
+}
+/* @
+ * world_record: WorldRoom*
+ * -------------------------
+ * Looks up the record of a visited room, reading its chunk back if needed.
+ * The pointer is valid until the next lookup.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Room coordinates.
+ * - write: bool - The caller changes the record (its chunk must be spilled again).
+ */
+static WorldRoom *world_record(World *w, int32_t x, int32_t y, bool write) {
+    WorldChunk *c = world_chunk(w, world_chunk_of(x), world_chunk_of(y), false);
+    if (c == NULL) {
+        return NULL;
+    }
+    WorldRoom *rec = world_chunk_room(c, x, y);
+    if (!(rec->state & WORLD_ROOM_USED)) {
+        return NULL;
+    }
+    c->dirty |= write;
+    return rec;
+}
+/* @
+ * world_find: WorldRoom*
+ * -----------------------
+ * Looks up the record of a visited room. The pointer is valid until the next
+ * call into the world map, which may evict its chunk.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Room coordinates.
+ *
+ * Returns:
+ * - The record, or NULL if the room was never visited (or was forgotten).
+ */
+WorldRoom *world_find(World *w, int32_t x, int32_t y) {
+    return world_record(w, x, y, false);
+}
+/* @
+ * world_doors_at: bool
+ * ---------------------
+ * Doors of a known room, as the player would find them.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Room coordinates.
+ * - doors: unsigned char* - Receives the door bits.
+ *
+ * Returns:
+ * - false if the room is unknown. Every room of a procedural world is known.
+ */
+bool world_doors_at(World *w, int32_t x, int32_t y, unsigned char *doors) {
+    WorldRoom *rec = world_find(w, x, y);
+    if (rec != NULL) {
+        *doors = rec->doors;
+        return true;
+    }
+    if (w->procedural) {
+        *doors = world_doors(w->seed, x, y);
+        return true;
+    }
+    return false;
+}
+/* @
+ * world_count_frontier: void
+ * ---------------------------
+ * Recounts the open doors that lead to unknown rooms, after rooms were
+ * forgotten or the map was replaced. Only chunks in memory are counted and
+ * rooms of spilled chunks are taken as known, so the count can only be low,
+ * which opens a frontier door early rather than too late.
+ */
+static void world_count_frontier(World *w) {
+    w->frontier = 0;
+    w->forgot = false;
+    for (uint16_t n = 0; n < w->resident; n++) {
+        for (int i = 0; i < WORLD_CHUNK_ROOMS; i++) {
+            WorldRoom *rec = &w->chunks[n].rooms[i];
+            if (!(rec->state & WORLD_ROOM_USED)) {
+                continue;
+            }
+            for (int d = 0; d < 4; d++) {
+                int32_t nx = rec->x, ny = rec->y;
+                world_step(d, &nx, &ny);
+                if ((rec->doors & (1 << d)) && !world_known(w, nx, ny)) {
+                    w->frontier++;
+                }
+            }
+        }
+    }
+}
+/* @
+ * world_open_frontier: void
+ * --------------------------
+ * Opens a door from some remembered room towards an unknown one. Used when
+ * the known rooms would otherwise form a closed area the player can't leave.
+ * Every remembered room is reachable from the player, so the new door is too.
+ */
+static void world_open_frontier(World *w) {
+    for (uint16_t n = 0; n < w->resident; n++) {
+        WorldChunk *c = &w->chunks[n];
+        for (int i = 0; i < WORLD_CHUNK_ROOMS; i++) {
+            WorldRoom *rec = &c->rooms[i];
+            if (!(rec->state & WORLD_ROOM_USED)) {
+                continue;
+            }
+            for (int d = 0; d < 4; d++) {
+                int32_t nx = rec->x, ny = rec->y;
+                world_step(d, &nx, &ny);
+                if (!world_known(w, nx, ny)) {
+                    rec->doors |= 1 << d;
+                    c->dirty = true;
+                    w->frontier++;
+                    w->version++;
+                    return;
+                }
+            }
+        }
+    }
+}
+/* @
+ * world_insert: WorldRoom*
+ * -------------------------
+ * Adds a record for a room that is not in the map yet.
+ */
+static WorldRoom *world_insert(World *w, int32_t x, int32_t y, uint32_t index) {
+    WorldChunk *c = world_chunk(w, world_chunk_of(x), world_chunk_of(y), true);
+    WorldRoom *rec = world_chunk_room(c, x, y);
+    memset(rec, 0, sizeof(*rec));
+    rec->x = x;
+    rec->y = y;
+    rec->index = index;
+    rec->state = WORLD_ROOM_USED;
+    c->count++;
+    c->dirty = true;
+    w->count++;
+    // procedural rooms are known before they are stored
+    if (!w->procedural) {
+        w->version++;
+    }
+    return rec;
+}
+/* @
+ * world_leave: void
+ * ------------------
+ * Stores what the player changed in a room (searched, looted item, killed
+ * or escaped mobs) before the room slot is recycled.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Coordinates of the room being left.
+ * - r: Room* - The room being left.
+ */
+void world_leave(World *w, int32_t x, int32_t y, Room *r) {
+    WorldRoom *rec = world_record(w, x, y, true);
+    if (rec == NULL && w->procedural) {
+        // untouched procedural rooms are not stored at all
+        unsigned char gone = 0;
+        for (int i = 0; i < 4; i++) {
+            if (r->mobs[i].type == ENEMY_NONE) {
+                gone |= 1 << i;
+            }
+        }
+        if (!r->searched && !r->item.looted && gone == w->entered_mobs) {
+            return;
+        }
+        rec = world_insert(w, x, y, 0);
+        rec->last_visit = w->entered_visit;
+    }
+    if (rec == NULL) {
+        return;
+    }
+    unsigned char state = rec->state & (WORLD_ROOM_USED | 0xF0);
+    if (r->searched) state |= WORLD_ROOM_SEARCHED;
+    if (r->item.looted) state |= WORLD_ROOM_LOOTED;
+    for (int i = 0; i < 4; i++) {
+        if (r->mobs[i].type == ENEMY_NONE) {
+            state |= 0x10 << i;
+        }
+    }
+    rec->state = state;
+    if (rec->doors != (unsigned char)r->doors) {
+        rec->doors = (unsigned char)r->doors;
+        w->version++;
+    }
+}
+/* @
+ * world_rebuild: void
+ * --------------------
+ * Regenerates a room from its generation index and applies its record.
+ */
+static void world_rebuild(World *w, WorldRoom *rec, Rng *rng, Room *r) {
+    if (w->procedural) {
+        world_generate(w, rec->x, rec->y, r);
+    } else {
+        Rng room_rng;
+        rng_fork(rng, &room_rng, RNG_DOMAIN_ROOM, rec->index);
+        room_create_random(r, 0, &room_rng);
+        r->doors = rec->doors;
+    }
+    r->searched = (rec->state & WORLD_ROOM_SEARCHED) != 0;
+    r->item.looted = (rec->state & WORLD_ROOM_LOOTED) != 0;
+    for (int i = 0; i < 4; i++) {
+        if (rec->state & (0x10 << i)) {
+            memset(&r->mobs[i], 0, sizeof(r->mobs[i]));
+        }
+    }
+}
+/* @
+ * world_enter: void
+ * ------------------
+ * Fills r with the room at (x, y): the remembered one if the player was there
+ * before, otherwise a new random room whose doors agree with every known
+ * neighbor (open towards neighbors that have a door to it, closed towards
+ * neighbors that don't). At least one door always leads to an unknown room,
+ * so the player can't get walled in.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Room coordinates.
+ * - rng: Rng* - Session generator, rooms are forked from it.
+ * - r: Room* - Room slot to fill.
+ * - visit: uint32_t - Current rooms_walked, for forgetting old rooms.
+ *
+ * Returns:
+ * - The room's generation index (0 for procedural rooms, their coordinates are enough).
+ */
+uint32_t world_enter(World *w, int32_t x, int32_t y, Rng *rng, Room *r, uint32_t visit) {
+    WorldRoom *rec = world_record(w, x, y, true);
+    if (w->procedural) {
+        if (rec != NULL) {
+            world_rebuild(w, rec, rng, r);
+            rec->last_visit = visit;
+        } else {
+            world_generate(w, x, y, r);
+        }
+        // remembered so world_leave can tell whether the player changed anything
+        w->entered_mobs = 0;
+        for (int i = 0; i < 4; i++) {
+            if (r->mobs[i].type == ENEMY_NONE) {
+                w->entered_mobs |= 1 << i;
+            }
+        }
+        w->entered_visit = visit;
+        return 0;
+    }
+    if (rec != NULL) {
+        world_rebuild(w, rec, rng, r);
+        rec->last_visit = visit;
+        return rec->index;
+    }
+
+    if (w->forgot) {
+        world_count_frontier(w);
+    }
+    unsigned char known = 0, open = 0;
+    for (int d = 0; d < 4; d++) {
+        int32_t nx = x, ny = y;
+        world_step(d, &nx, &ny);
+        WorldRoom *n = world_find(w, nx, ny);
+        if (n != NULL) {
+            known |= 1 << d;
+            if (n->doors & room_get_door_bit(d)) {
+                open |= 1 << d;
+                // that door leads somewhere known now; after a recount that took
+                // spilled rooms as known it may not have been counted at all
+                if (w->frontier > 0) {
+                    w->frontier--;
+                }
+            }
+        }
+    }
+    uint32_t index = w->next_index++;
+    Rng room_rng;
+    rng_fork(rng, &room_rng, RNG_DOMAIN_ROOM, index);
+    room_create_random(r, open, &room_rng);
+    r->doors = (r->doors & ~known) | open;
+    for (int d = 0; d < 4; d++) {
+        if ((r->doors & (1 << d)) && !(known & (1 << d))) {
+            w->frontier++;
+        }
+    }
+    // never let the known rooms close up around the player
+    if (w->frontier == 0) {
+        if (known != 0b1111) {
+            int d = 0;
+            while (known & (1 << d)) {
+                d++;
+            }
+            r->doors |= 1 << d;
+            w->frontier++;
+        } else {
+            world_open_frontier(w);
+        }
+    }
+
+    rec = world_insert(w, x, y, index);
+    rec->doors = (unsigned char)r->doors;
+    rec->last_visit = visit;
+    return index;
+}
+/* @
+ * world_adopt: void
+ * ------------------
+ * Makes r the room at (x, y) of a freshly reset map, e.g. after a load.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - x, y: int32_t - Coordinates of the room.
+ * - index: uint32_t - Its generation index.
+ * - r: Room* - The room.
+ * - visit: uint32_t - Current rooms_walked.
+ */
+void world_adopt(World *w, int32_t x, int32_t y, uint32_t index, Room *r, uint32_t visit) {
+    if (w->procedural) {
+        // stored only if it differs from the generated room
+        Room generated;
+        world_enter(w, x, y, NULL, &generated, visit);
+        world_leave(w, x, y, r);
+        return;
+    }
+    w->next_index = index + 1;
+    WorldRoom *rec = world_insert(w, x, y, index);
+    rec->last_visit = visit;
+    world_leave(w, x, y, r);
+    world_count_frontier(w);
+}
+/* @
+ * world_export: bool
+ * -------------------
+ * Takes an image of the map that can be saved without touching the World
+ * again (e.g. from the save writer thread). The rooms of the chunks in memory
+ * are copied, spilled chunks are only listed: their records stay as they are
+ * until the image is freed and are read with world_image_read, so nothing is
+ * read from disk here.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - image: WorldImage* - Receives the image, release it with world_image_free.
+ *
+ * Returns:
+ * - false if out of memory or the spill file can't be flushed, image is then empty.
+ *
+ * Notes:
+ * - Resident chunks come first in chunk order, so world_import lays them out
+ *   the same way while they fit in memory: the frontier is counted and opened
+ *   in that order.
+ */
+bool world_export(World *w, WorldImage *image) {
+    memset(image, 0, sizeof(*image));
+    image->procedural = w->procedural;
+    image->map = true;
+    image->forgot = w->forgot;
+    image->seed = w->seed;
+    image->next_index = w->next_index;
+    image->frontier = w->frontier;
+    image->entered_mobs = w->entered_mobs;
+    image->entered_visit = w->entered_visit;
+    image->world = w;
+    uint32_t capacity = 0;
+    for (uint16_t n = 0; n < w->resident; n++) {
+        capacity += w->chunks[n].count;
+    }
+    if ((capacity > 0 && (image->rooms = malloc(capacity * sizeof(WorldRoom))) == NULL)
+        || (w->spilled_count > 0 && (image->spilled = malloc(w->spilled_count * sizeof(WorldSpilled))) == NULL)) {
+        world_image_free(image);
+        return false;
+    }
+    for (uint16_t n = 0; n < w->resident; n++) {
+        WorldChunk *c = &w->chunks[n];
+        for (int i = 0; i < WORLD_CHUNK_ROOMS && image->count < capacity; i++) {
+            if (c->rooms[i].state & WORLD_ROOM_USED) {
+                image->rooms[image->count++] = c->rooms[i];
+            }
+        }
+    }
+    for (uint32_t i = 0; i < w->spilled_capacity; i++) {
+        WorldSpilled *e = &w->spilled[i];
+        if (e->record != 0 && world_resident(w, e->cx, e->cy) == NULL) {
+            w->record_refs[e->record - 1]++;
+            image->spilled[image->spilled_count++] = *e;
+        }
+    }
+    if (image->spilled_count > 0) {
+        // the records must reach the file before anything reads them from another thread
+        bool flushed = fflush(w->spill) == 0;
+#ifndef _WIN32
+        flushed = flushed && (image->spill = dup(fileno(w->spill)) + 1) > 0;
+#endif
+        if (!flushed) {
+            world_image_free(image);
+            return false;
+        }
+    }
+    return true;
+}
+/* @
+ * world_image_read: bool
+ * -----------------------
+ * Reads a spilled chunk of an image. Safe on any thread while the image lives:
+ * it only reads the image's own records.
+ *
+ * Parameters:
+ * - image: WorldImage* - From world_export.
+ * - i: uint32_t - Which of image->spilled.
+ * - c: WorldChunk* - Receives the chunk.
+ *
+ * Returns:
+ * - false if the record can't be read or is not the chunk it should be.
+ *
+ * Notes:
+ * - Without pthreads (Windows) saves are written on the game thread, the
+ *   World's own file is used.
+ */
+bool world_image_read(WorldImage *image, uint32_t i, WorldChunk *c) {
+    WorldSpilled *e = &image->spilled[i];
+    unsigned char data[WORLD_CHUNK_RECORD];
+    memset(c, 0, sizeof(*c));
+#ifdef _WIN32
+    FILE *spill = image->world != NULL ? image->world->spill : NULL;
+    bool read = spill != NULL
+        && fseek(spill, (long)(e->record - 1) * WORLD_CHUNK_RECORD, SEEK_SET) == 0
+        && fread(data, WORLD_CHUNK_RECORD, 1, spill) == 1;
+#else
+    bool read = image->spill > 0
+        && pread(image->spill - 1, data, WORLD_CHUNK_RECORD, (off_t)(e->record - 1) * WORLD_CHUNK_RECORD) == WORLD_CHUNK_RECORD;
+#endif
+    return read && world_decode(data, e, c) && c->count == e->count;
+}
+/* @
+ * world_adopt_spill: bool
+ * ------------------------
+ * Clears the map for world_import and takes over the chunk file the spilled
+ * chunks of an image are in: their index entries and record references are
+ * set up, the other records are free.
+ *
+ * Parameters:
+ * - w: World* - The session's world map, without a chunk file of its own.
+ * - image: WorldImage* - The image.
+ * - spill: FILE* - The chunk file, opened for update.
+ * - records: uint32_t - Records in it.
+ *
+ * Returns:
+ * - false if out of memory, or if a chunk or record is listed twice or lies
+ *   beyond the end of the file. Nothing is changed then.
+ */
+static bool world_adopt_spill(World *w, WorldImage *image, FILE *spill, uint32_t records) {
+    uint32_t capacity = 256;
+    while (capacity < image->spilled_count * 2) {
+        capacity *= 2;
+    }
+    uint32_t records_capacity = records > 256 ? records : 256;
+    WorldSpilled *spilled = calloc(capacity, sizeof(WorldSpilled));
+    uint16_t *refs = calloc(records_capacity, sizeof(uint16_t));
+    uint32_t *free_records = malloc(records_capacity * sizeof(uint32_t));
+    bool ok = spilled != NULL && refs != NULL && free_records != NULL;
+    for (uint32_t i = 0; ok && i < image->spilled_count; i++) {
+        WorldSpilled *from = &image->spilled[i];
+        uint32_t k = world_chunk_hash(from->cx, from->cy) & (capacity - 1);
+        while (spilled[k].record != 0 && (spilled[k].cx != from->cx || spilled[k].cy != from->cy)) {
+            k = (k + 1) & (capacity - 1);
+        }
+        ok = from->record != 0 && from->record <= records && refs[from->record - 1] == 0
+            && spilled[k].record == 0;
+        if (ok) {
+            spilled[k] = *from;
+            refs[from->record - 1] = 1;
+        }
+    }
+    if (!ok) {
+        free(spilled);
+        free(refs);
+        free(free_records);
+        return false;
+    }
+    world_clear(w, image->procedural);
+    free(w->spilled);
+    free(w->record_refs);
+    free(w->free_records);
+    w->spilled = spilled;
+    w->spilled_capacity = capacity;
+    w->spilled_count = image->spilled_count;
+    w->record_refs = refs;
+    w->free_records = free_records;
+    w->records = records;
+    w->records_capacity = records_capacity;
+    w->free_count = 0;
+    for (uint32_t r = records; r > 0; r--) {
+        if (refs[r - 1] == 0) {
+            free_records[w->free_count++] = r;
+        }
+    }
+    w->spill = spill;
+    for (uint32_t i = 0; i < image->spilled_count; i++) {
+        w->count += image->spilled[i].count;
+    }
+    return true;
+}
+/* @
+ * world_import: bool
+ * -------------------
+ * Replaces the map with an image, e.g. from a save or a snapshot.
+ *
+ * Parameters:
+ * - w: World* - The session's world map.
+ * - image: WorldImage* - The image, with image->map set.
+ *
+ * Returns:
+ * - false if the map is left as it was: out of memory, or the image refers to
+ *   spilled chunks (a snapshot) and the chunk file they are in can't be
+ *   opened or this world already has one.
+ *
+ * Notes:
+ * - Spilled chunks of an image stay where they are: the session's chunk
+ *   file left by the previous run is opened and its records are read back on
+ *   demand, and checked then.
+ */
+bool world_import(World *w, WorldImage *image) {
+    if (image->spilled_count == 0) {
+        world_clear(w, image->procedural);
+    } else {
+        if (w->spill != NULL) {
+            return false;
+        }
+        FILE *spill = fopen(w->spill_path[0] != '\0' ? w->spill_path : world_spill_path, "r+b");
+        long size = -1;
+        if (spill != NULL && fseek(spill, 0, SEEK_END) == 0) {
+            size = ftell(spill);
+        }
+        if (size < 0 || !world_adopt_spill(w, image, spill, (uint32_t)(size / WORLD_CHUNK_RECORD))) {
+            if (spill != NULL) {
+                fclose(spill);
+            }
+            return false;
+        }
+    }
+    w->seed = image->seed;
+    for (uint32_t i = 0; i < image->count; i++) {
+        WorldRoom *from = &image->rooms[i];
+        WorldRoom *rec = world_record(w, from->x, from->y, true);
+        if (rec == NULL) {
+            rec = world_insert(w, from->x, from->y, from->index);
+        }
+        *rec = *from;
+    }
+    w->next_index = image->next_index;
+    w->frontier = image->frontier;
+    w->forgot = image->forgot;
+    w->entered_mobs = image->entered_mobs;
+    w->entered_visit = image->entered_visit;
+    w->version++;
+    return true;
+}
+/* @
+ * world_image_free: void
+ * -----------------------
+ * Releases an image. If it came from world_export, call it on the game
+ * thread: the World's records it held can be overwritten again.
+ */
+void world_image_free(WorldImage *image) {
+    for (uint32_t i = 0; image->world != NULL && i < image->spilled_count; i++) {
+        world_record_drop(image->world, image->spilled[i].record);
+    }
+#ifndef _WIN32
+    if (image->spill > 0) {
+        close(image->spill - 1);
+    }
+#endif
+    free(image->rooms);
+    free(image->spilled);
+    image->rooms = NULL;
+    image->spilled = NULL;
+    image->count = 0;
+    image->spilled_count = 0;
+    image->world = NULL;
+    image->spill = 0;
+}
\ No newline at end of file